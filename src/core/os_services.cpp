@@ -139,10 +139,40 @@ void OS::TMutex::unlock()
 //------------------------------------------------------------------------------
 //
 //
-//      TChannel
+//      TCondVar
 //
 //
-void OS::TChannel::push(uint8_t x)
+bool OS::TCondVar::wait(TMutex& mx, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if(mx.ValueTag != cur_proc_prio_tag())
+        return false;                                   // the caller must own the mutex
+
+    // release the mutex without rescheduling: notify can't slip in
+    // before the current process is placed to the waiters map
+    mx.ValueTag = 0;
+    resume_next_ready_isr(mx.ProcessMap);
+
+    cur_proc_timeout() = timeout;
+    suspend(ProcessMap);
+    bool notified = !is_timeouted(ProcessMap);          // false if waked up by timeout or by externals
+    cur_proc_timeout() = 0;
+
+    mx.lock();
+    return notified;
+}
+//------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------
+//
+//
+//      byte_channel
+//
+//
+template<typename S>
+void OS::byte_channel<S>::push(uint8_t x)
 {
     TCritSect cs;
 
@@ -152,11 +182,13 @@ void OS::TChannel::push(uint8_t x)
         suspend(ProducersProcessMap);
     }
 
+    const S before = Cbuf.get_count();
     Cbuf.put(x);
-    resume_all(ConsumersProcessMap);
+    wake_consumers(before);
 }
 //------------------------------------------------------------------------------
-uint8_t OS::TChannel::pop()
+template<typename S>
+uint8_t OS::byte_channel<S>::pop()
 {
     TCritSect cs;
     uint8_t x;
@@ -171,34 +203,231 @@ uint8_t OS::TChannel::pop()
     return x;
 }
 //------------------------------------------------------------------------------
-void OS::TChannel::write(const uint8_t* data, const uint8_t count)
+template<typename S>
+void OS::byte_channel<S>::write(const uint8_t* data, const S count)
 {
     TCritSect cs;
 
-    while(Cbuf.get_free_size() < count)
+    if(count <= Cbuf.get_size())
     {
-        // channel has not enough space, suspend current process
-        suspend(ProducersProcessMap);
+        while(Cbuf.get_free_size() < count)
+        {
+            // channel has not enough space, suspend current process
+            suspend(ProducersProcessMap);
+        }
+
+        const S before = Cbuf.get_count();
+        Cbuf.write(data, count);
+        wake_consumers(before);
+        return;
+    }
+
+    // block is larger than the buffer: stream it in chunks
+    S left = count;
+    for(;;)
+    {
+        S chunk = Cbuf.get_free_size();
+        if(chunk)
+        {
+            if(chunk > left)
+                chunk = left;
+            const S before = Cbuf.get_count();
+            Cbuf.write(data, chunk);
+            data += chunk;
+            left -= chunk;
+            wake_consumers(before);
+            if(!left)
+                return;
+        }
+        else
+        {
+            suspend(ProducersProcessMap);
+        }
     }
+}
+//------------------------------------------------------------------------------
+template<typename S>
+void OS::byte_channel<S>::read(uint8_t* const data, const S count)
+{
+    TCritSect cs;
 
-    Cbuf.write(data, count);
-    resume_all(ConsumersProcessMap);
+    if(count <= Cbuf.get_size())
+    {
+        while(Cbuf.get_count() < count)
+        {
+            // channel doesn't contain enough data, suspend current process
+            suspend(ConsumersProcessMap);
+        }
+
+        Cbuf.read(data, count);
+        resume_all(ProducersProcessMap);
+        return;
+    }
+
+    // block is larger than the buffer: collect it in chunks
+    uint8_t* dst = data;
+    S left = count;
+    for(;;)
+    {
+        S chunk = Cbuf.get_count();
+        if(chunk)
+        {
+            if(chunk > left)
+                chunk = left;
+            Cbuf.read(dst, chunk);
+            dst  += chunk;
+            left -= chunk;
+            resume_all(ProducersProcessMap);
+            if(!left)
+                return;
+        }
+        else
+        {
+            suspend(ConsumersProcessMap);
+        }
+    }
 }
 //------------------------------------------------------------------------------
-void OS::TChannel::read(uint8_t* const data, const uint8_t count)
+template<typename S>
+uint8_t* OS::byte_channel<S>::reserve(const S cnt, timeout_t timeout)
 {
     TCritSect cs;
 
-    while(Cbuf.get_count() < count)
+    if(cnt > Cbuf.get_size())
+        return 0;
+
+    if(Cbuf.get_free_size() < cnt)
     {
-        // channel doesn't contain enough data, suspend current process
-        suspend(ConsumersProcessMap);
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // channel has not enough free space, suspend current process until data removed or timeout
+            suspend(ProducersProcessMap);
+            if(is_timeouted(ProducersProcessMap))
+                return 0;
+        }
+        while(Cbuf.get_free_size() < cnt);
+        cur_proc_timeout() = 0;
     }
 
-    Cbuf.read(data, count);
+    uint8_t* ptr;
+    Cbuf.rewind();
+    if(Cbuf.write_span(ptr) < cnt)
+        return 0;                                 // free space is split by the buffer end
+    return ptr;
+}
+//------------------------------------------------------------------------------
+template<typename S>
+void OS::byte_channel<S>::commit(const S cnt)
+{
+    TCritSect cs;
+
+    const S before = Cbuf.get_count();
+    Cbuf.commit_write(cnt);
+    wake_consumers(before);
+}
+//------------------------------------------------------------------------------
+template<typename S>
+const uint8_t* OS::byte_channel<S>::peek(S& cnt, timeout_t timeout)
+{
+    TCritSect cs;
+
+    uint8_t* ptr;
+    S span = Cbuf.read_span(ptr);
+    if(!span)
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // channel is empty, suspend current process until data received or timeout
+            suspend(ConsumersProcessMap);
+            if(is_timeouted(ConsumersProcessMap))
+            {
+                cnt = 0;
+                return 0;
+            }
+            span = Cbuf.read_span(ptr);
+        }
+        while(!span);
+        cur_proc_timeout() = 0;
+    }
+
+    if(span < cnt)
+        cnt = span;
+    return ptr;
+}
+//------------------------------------------------------------------------------
+template<typename S>
+void OS::byte_channel<S>::consume(const S cnt)
+{
+    TCritSect cs;
+
+    Cbuf.commit_read(cnt);
     resume_all(ProducersProcessMap);
 }
 //------------------------------------------------------------------------------
+template<typename S>
+void OS::byte_channel<S>::wait_line(const uint8_t delim, const S limit)
+{
+    // waiters share the gate: the first one sets it, others widen it
+    if(!LineWaitersProcessMap)
+    {
+        WaitDelim = delim;
+        WakeLevel = limit;
+    }
+    else
+    {
+        if(WaitDelim != delim)
+            WaitDelim = NO_DELIM;
+        if(WakeLevel > limit)
+            WakeLevel = limit;
+    }
+    suspend(LineWaitersProcessMap);
+}
+//------------------------------------------------------------------------------
+template<typename S>
+S OS::byte_channel<S>::read_until(const uint8_t delim, uint8_t* const data, const S max, timeout_t timeout)
+{
+    TCritSect cs;
+
+    const S limit = max < Cbuf.get_size() ? max : Cbuf.get_size();
+    S       n;
+
+    cur_proc_timeout() = timeout;
+    for(;;)
+    {
+        // scan from the start: other consumers may have taken data meanwhile
+        const S count = Cbuf.get_count();
+        const S pos   = Cbuf.find(delim);
+        if(pos < count)
+        {
+            n = pos + 1;
+            break;
+        }
+        if(count >= limit)
+        {
+            n = count;                            // no delimiter within max bytes
+            break;
+        }
+
+        // no complete line yet, suspend current process until delimiter received or timeout
+        wait_line(delim, limit);
+        if(is_timeouted(LineWaitersProcessMap))
+            return 0;
+    }
+    cur_proc_timeout() = 0;
+
+    if(n > max)
+        n = max;
+    Cbuf.read(data, n);
+    resume_all(ProducersProcessMap);
+    return n;
+}
+//------------------------------------------------------------------------------
+template class OS::byte_channel<uint8_t>;
+template class OS::byte_channel<uint16_t>;
+template class OS::byte_channel<uint32_t>;
+//------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
 //
@@ -10,6 +10,9 @@
   */
 #ifndef OS_SERVICES_H
 #define OS_SERVICES_H
+
+#include <atomic>
+
 namespace OS
 {
 
@@ -150,6 +153,7 @@ namespace OS
 
     class TMutex : protected TService
     {
+        friend class TCondVar;
     public:
         INLINE TMutex() : ProcessMap(0), ValueTag(0) { }
                void lock();
@@ -178,13 +182,68 @@ namespace OS
 
     typedef TScopedLock<OS::TMutex> TMutexLocker;
 
+    //--------------------------------------------------------------------------
+    //
+    //   Condition variable bound to TMutex
+    //
+    //   wait() releases the mutex and suspends on the waiters map in one
+    //   critical section, so notification can not be lost; the mutex is
+    //   reacquired before return. Returns false on timeout or when the
+    //   caller does not own the mutex.
+    //
+    class TCondVar : protected TService
+    {
+    public:
+        INLINE TCondVar() : ProcessMap(0) { }
+
+               bool wait(TMutex& mx, timeout_t timeout = 0);
+        INLINE void notify_one() { TCritSect cs; resume_next_ready(ProcessMap); }
+        INLINE void notify_all() { TCritSect cs; resume_all(ProcessMap);        }
+        INLINE void notify_isr() { TCritSect cs; resume_all_isr(ProcessMap);    }
+
+    protected:
+        volatile TProcessMap ProcessMap;
+    };
+
 
-    class TChannel : protected TService
+    //--------------------------------------------------------------------------
+    //
+    //   Byte channel over an external buffer
+    //
+    //   Index type S sets the maximal buffer size: TChannel (uint8_t) keeps
+    //   the compact 255-byte variant for tiny targets, TChannel16/TChannel32
+    //   serve multi-kilobyte buffers. Transfers longer than the buffer are
+    //   streamed through it in chunks.
+    //
+    //   reserve()/commit() and peek()/consume() give zero-copy access to
+    //   the buffer: a producer (e.g. DMA or a parser) fills the reserved
+    //   region in place, a consumer processes the peeked region in place.
+    //   reserve(cnt) grants cnt contiguous bytes or nothing: it waits while
+    //   less than cnt bytes are free, but returns 0 at once if enough bytes
+    //   are free and split by the buffer end - space at the buffer start is
+    //   not handed out while older data is queued behind it. The caller
+    //   may fall back to write() or retry later; an empty buffer always
+    //   restarts at its beginning. peek() may return a shorter region at
+    //   the buffer end - consume it and peek again for the rest.
+    //   Waiting and wake-ups happen only in reserve/peek and commit/consume.
+    //   Only one producer (consumer) may use reserve (peek) at a time.
+    //
+    //   read_until() serves line-based protocols: it returns a whole line
+    //   ending with the delimiter in one call. Its waiters have their own
+    //   process map: producers wake them only when the new data contains the
+    //   delimiter or the line can't grow any more (max bytes collected or
+    //   buffer full), while other consumers are waked on any data.
+    //
+    template<typename S>
+    class byte_channel : protected TService
     {
     public:
-        INLINE TChannel(uint8_t* buf, uint8_t size) 
+        INLINE byte_channel(uint8_t* buf, S size)
             : ProducersProcessMap(0)
             , ConsumersProcessMap(0)
+            , LineWaitersProcessMap(0)
+            , WaitDelim(NO_DELIM)
+            , WakeLevel(0)
             , Cbuf(buf, size)
         { 
         }
@@ -192,24 +251,103 @@ namespace OS
         void    push(uint8_t x);
         uint8_t pop();
 
-        void write(const uint8_t* data, const uint8_t count);
-        void read(uint8_t* const data, const uint8_t count);
+        void write(const uint8_t* data, const S count);
+        void read(uint8_t* const data, const S count);
+
+        // reads up to and including delim, at most max bytes; returns count
+        // read, 0 on timeout. The line is incomplete if the last byte isn't delim
+        S    read_until(const uint8_t delim, uint8_t* const data, const S max, timeout_t timeout = 0);
+
+        uint8_t*       reserve    (const S cnt, timeout_t timeout = 0);   // returns 0 on timeout
+        void           commit     (const S cnt);
+        INLINE void    commit_isr (const S cnt)
+        {
+            TCritSect cs;
+            const S before = Cbuf.get_count();
+            Cbuf.commit_write(cnt);
+            resume_all_isr(ConsumersProcessMap);
+            if(line_wanted(before))
+                resume_all_isr(LineWaitersProcessMap);
+        }
+        const uint8_t* peek       (S& cnt, timeout_t timeout = 0);   // returns 0 on timeout
+        void           consume    (const S cnt);
+        INLINE void    consume_isr(const S cnt) { TCritSect cs; Cbuf.commit_read(cnt);  resume_all_isr(ProducersProcessMap); }
 
-        INLINE uint8_t get_count() const { TCritSect cs; return Cbuf.get_count(); }
+        INLINE S get_count() const { TCritSect cs; return Cbuf.get_count(); }
 
     protected:
+        enum { NO_DELIM = 0x100 };                  // line waiters with different delimiters
+
+        // data written after 'before' bytes may complete a line of a read_until() waiter
+        INLINE bool line_wanted(const S before) const
+        {
+            if(!LineWaitersProcessMap)
+                return false;
+            if(WaitDelim == NO_DELIM)
+                return true;
+            const S count = Cbuf.get_count();
+            return count >= WakeLevel || Cbuf.find(static_cast<uint8_t>(WaitDelim), before) < count;
+        }
+        // line_wanted() is evaluated before rescheduling: the woken processes may run and drain the buffer
+        INLINE void wake_consumers(const S before)
+        {
+            const bool wake_lines = line_wanted(before);
+            bool woken = resume_all_isr(ConsumersProcessMap);
+            if(wake_lines)
+                woken |= resume_all_isr(LineWaitersProcessMap);
+            if(woken)
+                reschedule();
+        }
+               void wait_line(const uint8_t delim, const S limit);
+
         volatile TProcessMap ProducersProcessMap;
         volatile TProcessMap ConsumersProcessMap;
-        usr::TCbuf Cbuf;
+        volatile TProcessMap LineWaitersProcessMap; // processes waiting in read_until()
+        uint_fast16_t        WaitDelim;             // delimiter the line waiters wait for
+        S                    WakeLevel;             // byte count that ends read_until() anyway
+        usr::cbuf<S> Cbuf;
     };
+
+    // function-members are defined in os_services.cpp for these index types only
+    extern template class byte_channel<uint8_t>;
+    extern template class byte_channel<uint16_t>;
+    extern template class byte_channel<uint32_t>;
+
+    typedef byte_channel<uint8_t>  TChannel;
+    typedef byte_channel<uint16_t> TChannel16;
+    typedef byte_channel<uint32_t> TChannel32;
     //--------------------------------------------------------------------------
 
-    template<typename T, uint16_t Size, typename S = uint8_t>
+    //--------------------------------------------------------------------------
+    //
+    //   What channel producers do when the channel is full
+    //
+    //   opBlock           - producer waits for free space (write_isr/push_isr
+    //                       accept only what fits)
+    //   opDropNewest      - producer never waits, items that don't fit are
+    //                       discarded
+    //   opOverwriteOldest - producer never waits, the oldest items are
+    //                       discarded to make room
+    //
+    //   Items a consumer holds through peek() are never overwritten: while
+    //   a peek is outstanding, opOverwriteOldest queues the newest items of
+    //   a burst that fit into the free space and discards the older ones.
+    //   A peek ends with consume() or with any read, pop or flush.
+    //
+    //   Discarded items are counted by get_dropped(). reserve() doesn't wait
+    //   with lossy policies - it returns 0 if cnt items are not free.
+    //
+    enum TOverflowPolicy { opBlock, opDropNewest, opOverwriteOldest };
+
+    template<typename T, uint16_t Size, typename S = uint8_t, TOverflowPolicy Policy = opBlock>
     class channel : protected TService
     {
     public:
         INLINE channel() : ProducersProcessMap(0)
                          , ConsumersProcessMap(0)
+                         , WakeLevel(Size)
+                         , Dropped(0)
+                         , Peeked(0)
                          , pool()
         {
         }
@@ -220,24 +358,112 @@ namespace OS
         bool read      (T* const data, const S cnt, timeout_t timeout = 0);
         S    read_isr  (T* const data, const S max_size);
 
-        void push      (const T& item);
-        void push_front(const T& item);
+        // batched reception: waits until at least min_cnt items are available
+        // or timeout expires, then reads up to max_cnt items; returns count read
+        S    read_some (T* const data, const S min_cnt, const S max_cnt, timeout_t timeout = 0);
+
+        // consumer-side watermark: waits until the channel holds at least
+        // count items, doesn't remove them; returns false on timeout
+        bool wait      (const S count, timeout_t timeout = 0);
 
+        // false if the item was dropped (lossy policies only)
+        bool push      (const T& item);
+        bool push_front(const T& item);
+        bool push_isr  (const T& item);             // false if the item was not queued
+
+        // move-aware insertion: the item is moved or constructed in place in the channel
+        INLINE bool push(T&& item) { return emplace(static_cast<T&&>(item)); }
+        template<typename... Args>
+        bool emplace   (Args&&... args);
+
+        // item is move-assigned from the channel
         bool pop     (T& item, timeout_t timeout = 0);
         bool pop_back(T& item, timeout_t timeout = 0);
+        bool try_pop (T& item);                     // never waits, false if channel is empty
 
-
+        // zero-copy access, see byte_channel for details
+        T*          reserve    (const S cnt, timeout_t timeout = 0);   // returns 0 on timeout
+        void        commit     (const S cnt);
+        INLINE void commit_isr (const S cnt) { TCritSect cs; pool.commit_write(cnt); wake_consumers_isr(); }
+        const T*    peek       (S& cnt, timeout_t timeout = 0);     // returns 0 on timeout
+        void        consume    (const S cnt);
+        INLINE void consume_isr(const S cnt) { TCritSect cs; Peeked = 0; pool.commit_read(cnt); resume_all_isr(ProducersProcessMap); }
 
         INLINE S    get_count()     const { TCritSect cs; return pool.get_count();     }
         INLINE S    get_free_size() const { TCritSect cs; return pool.get_free_size(); }
+        INLINE uint32_t get_dropped() const { TCritSect cs; return Dropped; }
                void flush();
 
     protected:
+        // Consumers are waked up only when the channel holds WakeLevel items:
+        // each waiting consumer lowers it to the count it needs, each wake-up
+        // resets it, so producers (ISRs especially) don't switch context on
+        // every small burst while a consumer waits for a batch.
+        INLINE void request_wake(const S count) { if(WakeLevel > count) WakeLevel = count; }
+        INLINE void wake_consumers()
+        {
+            if(pool.get_count() >= WakeLevel) { WakeLevel = Size; resume_all(ConsumersProcessMap); }
+        }
+        INLINE void wake_consumers_isr()
+        {
+            if(pool.get_count() >= WakeLevel) { WakeLevel = Size; resume_all_isr(ConsumersProcessMap); }
+        }
+               bool wait_count(const S count, timeout_t timeout);
+               bool make_room(const S count);       // count must not exceed Size
+               S    put(const T* data, const S count);  // never waits, returns count queued
+
         volatile TProcessMap ProducersProcessMap;
         volatile TProcessMap ConsumersProcessMap;
+        volatile S           WakeLevel;
+        uint32_t             Dropped;
+        S                    Peeked;                // items held by the consumer through peek()
         usr::ring_buffer<T, Size, S> pool;
     };
 
+    //--------------------------------------------------------------------------
+    //
+    //   Channel over usr::spsc_ring for one producer and one consumer
+    //
+    //   Data transfer doesn't mask interrupts at all. Kernel is entered only
+    //   when the consumer has to wait for data (ring is empty) or when the
+    //   producer has to wake up a waiting consumer. Producer never blocks:
+    //   push/write return false/truncated count when the ring is full.
+    //
+    template<typename T, uint16_t Size>
+    class spsc_channel : protected TService
+    {
+    public:
+        INLINE spsc_channel() : ConsumersProcessMap(0), ring() { }
+
+        INLINE bool     push     (const T& item)                 { bool res = ring.push(item);       wake_consumer();     return res; }
+        INLINE bool     push_isr (const T& item)                 { bool res = ring.push(item);       wake_consumer_isr(); return res; }
+        INLINE uint16_t write    (const T* data, uint16_t cnt)   { uint16_t n = ring.write(data, cnt); wake_consumer();     return n;   }
+        INLINE uint16_t write_isr(const T* data, uint16_t cnt)   { uint16_t n = ring.write(data, cnt); wake_consumer_isr(); return n;   }
+
+               bool     pop (T& item, timeout_t timeout = 0);
+               uint16_t read(T* const data, const uint16_t max_size, timeout_t timeout = 0);   // returns 0 on timeout
+
+        INLINE uint16_t get_count()     const { return ring.get_count();     }
+        INLINE uint16_t get_free_size() const { return ring.get_free_size(); }
+
+    protected:
+        INLINE void wake_consumer()
+        {
+            std::atomic_signal_fence(std::memory_order_seq_cst);     // data is in the ring before map is checked
+            if(ConsumersProcessMap) { TCritSect cs; resume_all(ConsumersProcessMap); }
+        }
+        INLINE void wake_consumer_isr()
+        {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            if(ConsumersProcessMap) { TCritSect cs; resume_all_isr(ConsumersProcessMap); }
+        }
+        INLINE bool wait_data(timeout_t timeout);
+
+        volatile TProcessMap ConsumersProcessMap;
+        usr::spsc_ring<T, Size> ring;
+    };
+    //--------------------------------------------------------------------------
+
     class TBaseMessage : protected TService
     {
     public:
@@ -267,6 +493,71 @@ namespace OS
         volatile T Msg;
     };
     //--------------------------------------------------------------------------
+    //
+    //   Latest-value cell for large payloads
+    //
+    //   Single writer (process or ISR), any number of readers. The data is
+    //   never copied inside a critical section. Writer alternates between two
+    //   buffers, so a reader always copies a completed value and retries only
+    //   if the writer started to overwrite that buffer during the copy.
+    //   Writer never blocks, readers never wait for a write in progress, so
+    //   both sides may run in ISRs.
+    //
+    //   Seq is 2*n when n writes are complete and odd while a write is in
+    //   progress; latest complete value is in Buf[(Seq >> 1) & 1].
+    //
+    //   A reader may copy a buffer the writer is overwriting and discard the
+    //   torn copy afterwards, which is defined for trivially copyable T only.
+    //
+    template<typename T>
+    class seqlock
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "seqlock: T must be trivially copyable");
+
+    public:
+        INLINE seqlock() : Seq(0), Buf() { }
+
+               void     write(const T& x);
+               void     read (T& x) const;
+        INLINE uint32_t sequence() const { return Seq >> 1; }   // count of complete writes
+
+    protected:
+        volatile uint32_t Seq;
+        T Buf[2];
+    };
+    //--------------------------------------------------------------------------
+    //
+    //   Triple buffer for one writer and one reader
+    //
+    //   Writer fills back() in place and publish()es it, reader update()s
+    //   and uses front() in place. Only buffer indices are swapped, in a
+    //   critical section of a few instructions, so payload of any size moves
+    //   between ISRs and processes without masking interrupts for the copy.
+    //
+    template<typename T>
+    class triple_buffer
+    {
+    public:
+        INLINE triple_buffer() : Middle(1), Back(0), Front(2), Buf() { }
+
+        INLINE       T& back()        { return Buf[Back];  }
+        INLINE const T& front() const { return Buf[Front]; }
+
+               void publish();
+               bool update();                   // returns true if front() has been replaced by fresh data
+
+        INLINE void write(const T& x) { back() = x; publish(); }
+        INLINE bool read (T& x)       { bool fresh = update(); x = front(); return fresh; }
+
+    protected:
+        enum { FRESH = 0x04, INDEX_MASK = 0x03 };
+
+        volatile uint8_t Middle;                // index of shared buffer and FRESH flag
+        uint8_t          Back;                  // owned by writer
+        uint8_t          Front;                 // owned by reader
+        T Buf[3];
+    };
+    //--------------------------------------------------------------------------
 }
 
 void OS::TEventFlag::signal()
@@ -291,45 +582,85 @@ void OS::TMutex::unlock_isr()
     resume_next_ready_isr(ProcessMap);
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-void OS::channel<T, Size, S>::push(const T& item)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::make_room(const S count)
 {
-    TCritSect cs;
+    const S free = pool.get_free_size();
+    if(free >= count)
+        return true;
 
-    while(!pool.get_free_size())
+    switch(Policy)
     {
-        // channel is full, suspend current process until data removed
-        suspend(ProducersProcessMap);
+    case opDropNewest:
+        Dropped += count;
+        return false;
+
+    case opOverwriteOldest:
+        Dropped += count - free;
+        if(Peeked)                                // the oldest items are in use
+            return false;
+        pool.drop_front(count - free);
+        return true;
+
+    default:
+        while(pool.get_free_size() < count)
+        {
+            // channel does not have enough space, suspend current process until data removed
+            suspend(ProducersProcessMap);
+        }
+        return true;
     }
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::push(const T& item)
+{
+    TCritSect cs;
+
+    if(!make_room(1))
+        return false;
 
     pool.push_back(item);
-    resume_all(ConsumersProcessMap);
+    wake_consumers();
+    return true;
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-void OS::channel<T, Size, S>::push_front(const T& item)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::push_front(const T& item)
 {
     TCritSect cs;
 
-    while(!pool.get_free_size())
-    {
-        // channel is full, suspend current process until data removed
-        suspend(ProducersProcessMap);
-    }
+    if(!make_room(1))
+        return false;
 
     pool.push_front(item);
-    resume_all(ConsumersProcessMap);
+    wake_consumers();
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+template<typename... Args>
+bool OS::channel<T, Size, S, Policy>::emplace(Args&&... args)
+{
+    TCritSect cs;
 
+    if(!make_room(1))
+        return false;
+
+    pool.emplace_back(static_cast<Args&&>(args)...);
+    wake_consumers();
+    return true;
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-bool OS::channel<T, Size, S>::pop(T& item, timeout_t timeout)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::pop(T& item, timeout_t timeout)
 {
     TCritSect cs;
 
     if(pool.get_count())
     {
-        item = pool.pop();
+        Peeked = 0;
+        pool.pop_front(item);
         resume_all(ProducersProcessMap);
         return true;
     }
@@ -340,6 +671,7 @@ bool OS::channel<T, Size, S>::pop(T& item, timeout_t timeout)
         for(;;)
         {
             // channel is empty, suspend current process until data received or timeout
+            request_wake(1);
             suspend(ConsumersProcessMap);
             if(is_timeouted(ConsumersProcessMap))
                 return false;
@@ -347,7 +679,8 @@ bool OS::channel<T, Size, S>::pop(T& item, timeout_t timeout)
             if(pool.get_count())
             {
                 cur_proc_timeout() = 0;
-                item = pool.pop();
+                Peeked = 0;
+                pool.pop_front(item);
                 resume_all(ProducersProcessMap);
                 return true;
             }
@@ -356,14 +689,28 @@ bool OS::channel<T, Size, S>::pop(T& item, timeout_t timeout)
     }
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-bool OS::channel<T, Size, S>::pop_back(T& item, timeout_t timeout)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::try_pop(T& item)
+{
+    TCritSect cs;
+
+    if(!pool.pop_front(item))
+        return false;
+
+    Peeked = 0;
+    resume_all(ProducersProcessMap);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::pop_back(T& item, timeout_t timeout)
 {
     TCritSect cs;
 
     if(pool.get_count())
     {
-        item = pool.pop_back();
+        Peeked = 0;
+        pool.pop_back(item);
         resume_all(ProducersProcessMap);
         return true;
     }
@@ -374,6 +721,7 @@ bool OS::channel<T, Size, S>::pop_back(T& item, timeout_t timeout)
         for(;;)
         {
             // channel is empty, suspend current process until data received or timeout
+            request_wake(1);
             suspend(ConsumersProcessMap);
             if(is_timeouted(ConsumersProcessMap))
                 return false;
@@ -381,7 +729,8 @@ bool OS::channel<T, Size, S>::pop_back(T& item, timeout_t timeout)
             if(pool.get_count())
             {
                 cur_proc_timeout() = 0;
-                item = pool.pop_back();
+                Peeked = 0;
+                pool.pop_back(item);
                 resume_all(ProducersProcessMap);
                 return true;
             }
@@ -390,76 +739,343 @@ bool OS::channel<T, Size, S>::pop_back(T& item, timeout_t timeout)
     }
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-void OS::channel<T, Size, S>::flush()
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+void OS::channel<T, Size, S, Policy>::flush()
 {
     TCritSect cs;
+    Peeked = 0;
     pool.flush();
     resume_all(ProducersProcessMap);
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-void OS::channel<T, Size, S>::write(const T* data, const S count)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+void OS::channel<T, Size, S, Policy>::write(const T* data, const S count)
 {
     TCritSect cs;
 
-    while(pool.get_free_size() < count)
+    if(Policy == opBlock)
     {
-        // channel does not have enough space, suspend current process until data removed
-        suspend(ProducersProcessMap);
+        make_room(count);
+        pool.write(data, count);
     }
-
-    pool.write(data, count);
-    resume_all(ConsumersProcessMap);
+    else
+    {
+        put(data, count);
+    }
+    wake_consumers();
 
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-S OS::channel<T, Size, S>::write_isr(const T* data, const S count)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+S OS::channel<T, Size, S, Policy>::write_isr(const T* data, const S count)
 {
     TCritSect cs;
 
-    const S free = pool.get_free_size();
-    S qty = free < count ? free : count;
+    const S qty = put(data, count);
+    wake_consumers_isr();
+    return qty;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+S OS::channel<T, Size, S, Policy>::put(const T* data, const S count)
+{
+    S qty = count;
+    if(Policy == opOverwriteOldest)
+    {
+        if(qty > Size)                            // only the last Size items survive
+        {
+            Dropped += qty - Size;
+            data    += qty - Size;
+            qty      = Size;
+        }
+        if(!make_room(qty))                       // peeked items stay, keep the newest items that fit
+        {
+            const S free = pool.get_free_size();
+            data += qty - free;
+            qty   = free;
+        }
+    }
+    else
+    {
+        const S free = pool.get_free_size();
+        if(free < qty)
+        {
+            if(Policy == opDropNewest)
+                Dropped += qty - free;
+            qty = free;
+        }
+    }
+
     pool.write(data, qty);
-    resume_all_isr(ConsumersProcessMap);
     return qty;
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-bool OS::channel<T, Size, S>::read(T* const data, const S count, timeout_t timeout)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::push_isr(const T& item)
 {
     TCritSect cs;
 
+    if(Policy == opBlock)
+    {
+        if(!pool.get_free_size())
+            return false;
+    }
+    else if(!make_room(1))
+        return false;
+
+    pool.push_back(item);
+    wake_consumers_isr();
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::wait_count(const S count, timeout_t timeout)
+{
+    if(pool.get_count() >= count)
+        return true;
+
     cur_proc_timeout() = timeout;
 
-    while(pool.get_count() < count)
+    do
     {
         // channel doesn't contain enough data, suspend current process until data received or timeout
+        request_wake(count);
         suspend(ConsumersProcessMap);
         if(is_timeouted(ConsumersProcessMap))
             return false;
     }
+    while(pool.get_count() < count);
 
     cur_proc_timeout() = 0;
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::wait(const S count, timeout_t timeout)
+{
+    TCritSect cs;
+
+    return wait_count(count, timeout);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+bool OS::channel<T, Size, S, Policy>::read(T* const data, const S count, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if(!wait_count(count, timeout))
+        return false;
+
+    Peeked = 0;
     pool.read(data, count);
     resume_all(ProducersProcessMap);
 
     return true;
 }
 //------------------------------------------------------------------------------
-template<typename T, uint16_t Size, typename S>
-S OS::channel<T, Size, S>::read_isr(T* const data, const S max_size)
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+S OS::channel<T, Size, S, Policy>::read_some(T* const data, const S min_cnt, const S max_cnt, timeout_t timeout)
+{
+    TCritSect cs;
+
+    wait_count(min_cnt, timeout);                 // on timeout take whatever has been received
+
+    const S avail = pool.get_count();
+    S count = avail < max_cnt ? avail : max_cnt;
+    if(count)
+    {
+        Peeked = 0;
+        pool.read(data, count);
+        resume_all(ProducersProcessMap);
+    }
+    return count;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+S OS::channel<T, Size, S, Policy>::read_isr(T* const data, const S max_size)
 {
     TCritSect cs;
 
     const S avail = pool.get_count();
     S count = avail < max_size ? avail : max_size;
+    if(count)
+        Peeked = 0;
     pool.read(data, count);
     resume_all_isr(ProducersProcessMap);
     return count;
 }
 //------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+T* OS::channel<T, Size, S, Policy>::reserve(const S cnt, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if(cnt > Size)
+        return 0;
+
+    if(pool.get_free_size() < cnt)
+    {
+        if(Policy != opBlock)
+            return 0;
+
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // channel has not enough free space, suspend current process until data removed or timeout
+            suspend(ProducersProcessMap);
+            if(is_timeouted(ProducersProcessMap))
+                return 0;
+        }
+        while(pool.get_free_size() < cnt);
+        cur_proc_timeout() = 0;
+    }
+
+    T* ptr;
+    pool.rewind();
+    if(pool.write_span(ptr) < cnt)
+        return 0;                                 // free space is split by the buffer end
+    return ptr;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+void OS::channel<T, Size, S, Policy>::commit(const S cnt)
+{
+    TCritSect cs;
+
+    pool.commit_write(cnt);
+    wake_consumers();
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+const T* OS::channel<T, Size, S, Policy>::peek(S& cnt, timeout_t timeout)
+{
+    TCritSect cs;
+
+    T* ptr;
+    S span = pool.read_span(ptr);
+    if(!span)
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // channel is empty, suspend current process until data received or timeout
+            request_wake(1);
+            suspend(ConsumersProcessMap);
+            if(is_timeouted(ConsumersProcessMap))
+            {
+                cnt = 0;
+                return 0;
+            }
+            span = pool.read_span(ptr);
+        }
+        while(!span);
+        cur_proc_timeout() = 0;
+    }
+
+    if(span < cnt)
+        cnt = span;
+    Peeked = cnt;
+    return ptr;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, OS::TOverflowPolicy Policy>
+void OS::channel<T, Size, S, Policy>::consume(const S cnt)
+{
+    TCritSect cs;
+
+    Peeked = 0;
+    pool.commit_read(cnt);
+    resume_all(ProducersProcessMap);
+}
+//------------------------------------------------------------------------------
+
+
+template<typename T, uint16_t Size>
+bool OS::spsc_channel<T, Size>::wait_data(timeout_t timeout)
+{
+    TCritSect cs;
+
+    if(!ring.empty())
+        return true;
+
+    cur_proc_timeout() = timeout;
+    do
+    {
+        // ring is empty, suspend current process until data received or timeout
+        suspend(ConsumersProcessMap);
+        if(is_timeouted(ConsumersProcessMap))
+            return false;
+    }
+    while(ring.empty());
+    cur_proc_timeout() = 0;
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size>
+bool OS::spsc_channel<T, Size>::pop(T& item, timeout_t timeout)
+{
+    if(ring.pop(item))
+        return true;
+
+    return wait_data(timeout) && ring.pop(item);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size>
+uint16_t OS::spsc_channel<T, Size>::read(T* const data, const uint16_t max_size, timeout_t timeout)
+{
+    uint16_t n = ring.read(data, max_size);
+    if(n || !max_size)
+        return n;
+
+    return wait_data(timeout) ? ring.read(data, max_size) : 0;
+}
+//------------------------------------------------------------------------------
+template<typename T>
+void OS::seqlock<T>::write(const T& x)
+{
+    uint32_t s = Seq;
+    Seq = s + 1;                                          // write in progress to the other buffer
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    Buf[((s >> 1) + 1) & 1] = x;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    Seq = s + 2;                                          // new value is complete
+}
+//------------------------------------------------------------------------------
+template<typename T>
+void OS::seqlock<T>::read(T& x) const
+{
+    for(;;)
+    {
+        uint32_t s = Seq;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        x = Buf[(s >> 1) & 1];
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        if(Seq - s < 2)                                   // writer didn't touch the buffer being copied
+            return;
+    }
+}
+//------------------------------------------------------------------------------
+template<typename T>
+void OS::triple_buffer<T>::publish()
+{
+    TCritSect cs;
+    uint8_t m = Middle;
+    Middle = Back | FRESH;
+    Back = m & INDEX_MASK;
+}
+//------------------------------------------------------------------------------
+template<typename T>
+bool OS::triple_buffer<T>::update()
+{
+    TCritSect cs;
+    uint8_t m = Middle;
+    if(!(m & FRESH))
+        return false;
+    Middle = Front;
+    Front = m & INDEX_MASK;
+    return true;
+}
+//------------------------------------------------------------------------------
 
 
 void OS::TBaseMessage::send()
@@ -18,7 +18,8 @@ using namespace usr;
 //
 //
 //
-TCbuf::TCbuf(uint8_t* const Address, const uint8_t Size) :
+template<typename S>
+cbuf<S>::cbuf(uint8_t* const Address, const S Size) :
         buf(Address),
         size(Size),
         count(0),
@@ -27,37 +28,70 @@ TCbuf::TCbuf(uint8_t* const Address, const uint8_t Size) :
 {
 }
 //------------------------------------------------------------------------------
-bool TCbuf::write(const uint8_t* data, const uint8_t Count)
+template<typename S>
+bool cbuf<S>::write(const uint8_t* data, const S Count)
 {
     if( Count > (size - count) )
         return false;
 
-    for(uint_fast8_t i = 0; i < Count; i++)
-        push(*(data++));
+    const S n1 = (size - last) < Count ? size - last : Count;   // part up to the end of the buffer
+    memcpy(buf + last, data, n1);
+    memcpy(buf, data + n1, Count - n1);
+    commit_write(Count);
 
     return true;
 }
 //------------------------------------------------------------------------------
-void TCbuf::read(uint8_t* data, const uint8_t Count)
+template<typename S>
+void cbuf<S>::read(uint8_t* data, const S Count)
 {
-    uint_fast8_t N = Count <= count ? Count : count;
+    const S N  = Count <= count ? Count : count;
+    const S n1 = (size - first) < N ? size - first : N;
 
-    for(uint_fast8_t i = 0; i < N; i++)
-        data[i] = pop();
+    memcpy(data, buf + first, n1);
+    memcpy(data + n1, buf, N - n1);
+    commit_read(N);
 }
 //------------------------------------------------------------------------------
-uint8_t TCbuf::get_byte(const uint8_t index) const
+template<typename S>
+uint8_t cbuf<S>::get_byte(const S index) const
 {
-    uint8_t x = first + index;
+    const S tail = size - first;
 
-    if(x < size)
-        return buf[x];
+    if(index < tail)
+        return buf[first + index];
     else
-        return buf[x - size];
+        return buf[index - tail];
 }
 
 //------------------------------------------------------------------------------
-bool TCbuf::put(const uint8_t item)
+template<typename S>
+S cbuf<S>::find(const uint8_t c, S from) const
+{
+    if(from >= count)
+        return count;
+
+    // data occupies [first, size) and then [0, ...) after wrap;
+    // memchr scans each contiguous segment in one go
+    const S tail = size - first;
+    if(from < tail)
+    {
+        const S end = count < tail ? count : tail;
+        const uint8_t* p = static_cast<const uint8_t*>(memchr(buf + first + from, c, end - from));
+        if(p)
+            return p - (buf + first);
+        if(count <= tail)
+            return count;
+        from = tail;
+    }
+
+    const uint8_t* p = static_cast<const uint8_t*>(memchr(buf + (from - tail), c, count - from));
+    return p ? tail + (p - buf) : count;
+}
+
+//------------------------------------------------------------------------------
+template<typename S>
+bool cbuf<S>::put(const uint8_t item)
 {
     if(count == size)
         return false;
@@ -66,7 +100,8 @@ bool TCbuf::put(const uint8_t item)
     return true;
 }
 //------------------------------------------------------------------------------
-uint8_t TCbuf::get()
+template<typename S>
+uint8_t cbuf<S>::get()
 {
     if(count)
         return pop();
@@ -79,7 +114,8 @@ uint8_t TCbuf::get()
 /// For internal purposes.
 /// Use this function with care - it doesn't perform free size check.
 //
-void TCbuf::push(const uint8_t item)
+template<typename S>
+void cbuf<S>::push(const uint8_t item)
 {
     buf[last] = item;
     last++;
@@ -94,7 +130,8 @@ void TCbuf::push(const uint8_t item)
 /// For internal purposes.
 /// Use this function with care - it doesn't perform free size check.
 //
-uint8_t TCbuf::pop()
+template<typename S>
+uint8_t cbuf<S>::pop()
 {
     uint8_t item = buf[first];
 
@@ -106,3 +143,371 @@ uint8_t TCbuf::pop()
     return item;
 }
 //------------------------------------------------------------------------------
+template class usr::cbuf<uint8_t>;
+template class usr::cbuf<uint16_t>;
+template class usr::cbuf<uint32_t>;
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+//
+///   TLSF heap function-member description
+//
+//    Block layout follows the reference TLSF implementation: a block pointer
+//    addresses its prev_phys field, which physically is the last word of the
+//    previous block and is valid only while that block is free. Payload
+//    starts right after the size word, so a used block costs one word.
+//    Payload sizes are kept equal to ALIGN*n - size word, so that every
+//    payload stays aligned even though the header is a single word.
+//
+//------------------------------------------------------------------------------
+struct usr::tlsf_block
+{
+    tlsf_block* prev_phys;
+    size_t      size;           // payload size, two low bits are flags
+    tlsf_block* next_free;      // valid in free blocks only
+    tlsf_block* prev_free;
+};
+
+namespace
+{
+    typedef usr::tlsf_block block;
+
+    const size_t FREE_BIT      = 1;
+    const size_t PREV_FREE_BIT = 2;
+    const size_t FLAG_BITS     = FREE_BIT | PREV_FREE_BIT;
+
+    const size_t HDR_OVERHEAD  = sizeof(size_t);
+    const size_t PTR_OFFSET    = offsetof(block, size) + sizeof(size_t);
+    const size_t BLOCK_MAX     = size_t(1) << tlsf_heap::FL_MAX;
+
+    // payload size for 'size' bytes of data, keeps the next payload aligned
+    inline size_t round_payload(size_t size)
+    {
+        return ((size + HDR_OVERHEAD + tlsf_heap::ALIGN - 1) & ~size_t(tlsf_heap::ALIGN - 1)) - HDR_OVERHEAD;
+    }
+
+    // free block keeps list links and the next block's prev_phys in its payload
+    const size_t BLOCK_MIN     = ((sizeof(block) + tlsf_heap::ALIGN - 1) & ~size_t(tlsf_heap::ALIGN - 1)) - HDR_OVERHEAD;
+
+    inline size_t size_of(const block* b)        { return b->size & ~FLAG_BITS; }
+    inline bool   is_free(const block* b)        { return b->size & FREE_BIT; }
+    inline bool   is_prev_free(const block* b)   { return b->size & PREV_FREE_BIT; }
+    inline void*  to_ptr(block* b)               { return reinterpret_cast<uint8_t*>(b) + PTR_OFFSET; }
+    inline block* from_ptr(void* p)              { return reinterpret_cast<block*>(static_cast<uint8_t*>(p) - PTR_OFFSET); }
+    inline block* offset(void* p, ptrdiff_t n)   { return reinterpret_cast<block*>(static_cast<uint8_t*>(p) + n); }
+    inline block* next_phys(block* b)            { return offset(to_ptr(b), size_of(b) - HDR_OVERHEAD); }
+
+    inline block* link_next(block* b)
+    {
+        block* next = next_phys(b);
+        next->prev_phys = b;
+        return next;
+    }
+    inline void mark_free(block* b)
+    {
+        block* next = link_next(b);
+        next->size |= PREV_FREE_BIT;
+        b->size    |= FREE_BIT;
+    }
+    inline void mark_used(block* b)
+    {
+        next_phys(b)->size &= ~PREV_FREE_BIT;
+        b->size &= ~FREE_BIT;
+    }
+
+    inline unsigned fls(size_t x)                { return 31 - __builtin_clz(static_cast<uint32_t>(x)); }
+    inline unsigned ffs(uint32_t x)              { return __builtin_ctz(x); }
+
+    inline void mapping(size_t size, unsigned& fl, unsigned& sl)
+    {
+        if(size < tlsf_heap::SMALL_SIZE)
+        {
+            fl = 0;
+            sl = size / (tlsf_heap::SMALL_SIZE / tlsf_heap::SL_COUNT);
+        }
+        else
+        {
+            fl = fls(size);
+            sl = (size >> (fl - tlsf_heap::SL_LOG2)) ^ tlsf_heap::SL_COUNT;
+            fl -= tlsf_heap::FL_SHIFT - 1;
+        }
+    }
+
+    inline size_t adjust_request(size_t size)
+    {
+        if(!size || size >= BLOCK_MAX)
+            return 0;
+        size = round_payload(size);
+        return size < BLOCK_MIN ? BLOCK_MIN : size;
+    }
+}
+//------------------------------------------------------------------------------
+bool tlsf_heap::init(void* mem, size_t size)
+{
+    FlBitmap = 0;
+    for(unsigned fl = 0; fl < FL_COUNT; ++fl)
+    {
+        SlBitmap[fl] = 0;
+        for(unsigned sl = 0; sl < SL_COUNT; ++sl)
+            Blocks[fl][sl] = 0;
+    }
+    Total    = 0;
+    Used     = 0;
+    Free     = 0;
+    PeakUsed = 0;
+
+    // first payload is aligned, the size word in front of it must be inside
+    // the area; the first block's prev_phys may lie before the area, it is
+    // never used because the previous-free flag is clear
+    uint8_t* const start   = static_cast<uint8_t*>(mem);
+    uint8_t* const payload = reinterpret_cast<uint8_t*>(
+        (reinterpret_cast<uintptr_t>(start) + HDR_OVERHEAD + ALIGN - 1) & ~uintptr_t(ALIGN - 1));
+    if(payload + BLOCK_MIN + HDR_OVERHEAD > start + size)
+        return false;
+
+    // leave room for the size word of the terminating sentinel
+    size_t bytes = ((start + size - payload) & ~size_t(ALIGN - 1)) - HDR_OVERHEAD;
+    if(bytes >= BLOCK_MAX)
+        bytes = BLOCK_MAX - ALIGN - HDR_OVERHEAD;
+    if(bytes < BLOCK_MIN)
+        return false;
+
+    block* b = from_ptr(payload);
+    b->size = bytes | FREE_BIT;
+    insert(b);
+
+    // zero-size used sentinel terminates the area
+    block* last = link_next(b);
+    last->size  = PREV_FREE_BIT;
+
+    Total = size;
+    return true;
+}
+//------------------------------------------------------------------------------
+void tlsf_heap::insert(block* b)
+{
+    unsigned fl, sl;
+    mapping(size_of(b), fl, sl);
+
+    block* head  = Blocks[fl][sl];
+    b->next_free = head;
+    b->prev_free = 0;
+    if(head)
+        head->prev_free = b;
+    Blocks[fl][sl] = b;
+
+    FlBitmap     |= 1ul << fl;
+    SlBitmap[fl] |= 1ul << sl;
+    Free += size_of(b);
+}
+//------------------------------------------------------------------------------
+void tlsf_heap::remove(block* b, unsigned fl, unsigned sl)
+{
+    block* prev = b->prev_free;
+    block* next = b->next_free;
+    if(next)
+        next->prev_free = prev;
+    if(prev)
+        prev->next_free = next;
+    else
+    {
+        Blocks[fl][sl] = next;
+        if(!next)
+        {
+            SlBitmap[fl] &= ~(1ul << sl);
+            if(!SlBitmap[fl])
+                FlBitmap &= ~(1ul << fl);
+        }
+    }
+    Free -= size_of(b);
+}
+//------------------------------------------------------------------------------
+void tlsf_heap::remove(block* b)
+{
+    unsigned fl, sl;
+    mapping(size_of(b), fl, sl);
+    remove(b, fl, sl);
+}
+//------------------------------------------------------------------------------
+tlsf_heap::block* tlsf_heap::find_free(size_t size)
+{
+    // round up to the next list boundary, so any block of the found list fits
+    if(size >= SMALL_SIZE)
+        size += (size_t(1) << (fls(size) - SL_LOG2)) - 1;
+
+    unsigned fl, sl;
+    mapping(size, fl, sl);
+    if(fl >= FL_COUNT)
+        return 0;
+
+    uint32_t sl_map = SlBitmap[fl] & (~0ul << sl);
+    if(!sl_map)
+    {
+        const uint32_t fl_map = fl + 1 < 32 ? FlBitmap & (~0ul << (fl + 1)) : 0;
+        if(!fl_map)
+            return 0;
+        fl     = ffs(fl_map);
+        sl_map = SlBitmap[fl];
+    }
+    sl = ffs(sl_map);
+
+    block* b = Blocks[fl][sl];
+    remove(b, fl, sl);
+    return b;
+}
+//------------------------------------------------------------------------------
+tlsf_heap::block* tlsf_heap::split(block* b, size_t size)
+{
+    // remaining part starts right after 'size' bytes of payload
+    block* rest = offset(to_ptr(b), size - HDR_OVERHEAD);
+    rest->size  = size_of(b) - (size + HDR_OVERHEAD);
+    b->size     = size | (b->size & FLAG_BITS);
+    mark_free(rest);
+    return rest;
+}
+//------------------------------------------------------------------------------
+tlsf_heap::block* tlsf_heap::merge_prev(block* b)
+{
+    if(is_prev_free(b))
+    {
+        block* prev = b->prev_phys;
+        remove(prev);
+        prev->size += size_of(b) + HDR_OVERHEAD;
+        link_next(prev);
+        b = prev;
+    }
+    return b;
+}
+//------------------------------------------------------------------------------
+tlsf_heap::block* tlsf_heap::merge_next(block* b)
+{
+    block* next = next_phys(b);
+    if(is_free(next))
+    {
+        remove(next);
+        b->size += size_of(next) + HDR_OVERHEAD;
+        link_next(b);
+    }
+    return b;
+}
+//------------------------------------------------------------------------------
+void* tlsf_heap::use(block* b, size_t size)
+{
+    // b is free and out of the lists: give the tail back if it is big enough
+    if(size_of(b) >= sizeof(block) + size)
+    {
+        insert(split(b, size));
+    }
+    mark_used(b);
+
+    Used += size_of(b);
+    if(Used > PeakUsed)
+        PeakUsed = Used;
+    return to_ptr(b);
+}
+//------------------------------------------------------------------------------
+void* tlsf_heap::malloc(size_t size)
+{
+    const size_t adjusted = adjust_request(size);
+    if(!adjusted)
+        return 0;
+
+    block* b = find_free(adjusted);
+    return b ? use(b, adjusted) : 0;
+}
+//------------------------------------------------------------------------------
+void tlsf_heap::free(void* ptr)
+{
+    if(!ptr)
+        return;
+
+    block* b = from_ptr(ptr);
+    Used -= size_of(b);
+    mark_free(b);
+    b = merge_prev(b);
+    b = merge_next(b);
+    insert(b);
+}
+//------------------------------------------------------------------------------
+void* tlsf_heap::realloc(void* ptr, size_t size)
+{
+    if(!ptr)
+        return malloc(size);
+    if(!size)
+    {
+        free(ptr);
+        return 0;
+    }
+    if(resize(ptr, size))
+        return ptr;
+
+    // can't grow in place
+    void* p = malloc(size);
+    if(p)
+    {
+        const size_t cur = usable_size(ptr);
+        memcpy(p, ptr, cur < size ? cur : size);
+        free(ptr);
+    }
+    return p;
+}
+//------------------------------------------------------------------------------
+bool tlsf_heap::resize(void* ptr, size_t size)
+{
+    block* b = from_ptr(ptr);
+    const size_t cur      = size_of(b);
+    const size_t adjusted = adjust_request(size);
+    if(!adjusted)
+        return false;
+
+    block* next = next_phys(b);
+    if(adjusted > cur && (!is_free(next) || adjusted > cur + size_of(next) + HDR_OVERHEAD))
+        return false;
+
+    Used -= cur;
+    if(adjusted > cur)
+    {
+        merge_next(b);
+        mark_used(b);
+    }
+
+    // give the tail back, merging it with the following free block
+    if(size_of(b) >= sizeof(block) + adjusted)
+    {
+        block* rest = split(b, adjusted);
+        rest->size &= ~PREV_FREE_BIT;
+        rest = merge_next(rest);
+        insert(rest);
+    }
+
+    Used += size_of(b);
+    if(Used > PeakUsed)
+        PeakUsed = Used;
+    return true;
+}
+//------------------------------------------------------------------------------
+size_t tlsf_heap::usable_size(const void* ptr)
+{
+    return size_of(from_ptr(const_cast<void*>(ptr)));
+}
+//------------------------------------------------------------------------------
+size_t tlsf_heap::get_largest_free() const
+{
+    if(!FlBitmap)
+        return 0;
+
+    // lower bound of the highest non-empty list: every block there is at least
+    // that large, so the result needs no list walk and a request of this size
+    // always succeeds
+    const unsigned fl = fls(FlBitmap);
+    const unsigned sl = fls(SlBitmap[fl]);
+    if(!fl)
+        return sl * (SMALL_SIZE / SL_COUNT);
+    return static_cast<size_t>(SL_COUNT | sl) << (fl + ALIGN_LOG2 - 1);
+}
+//------------------------------------------------------------------------------
+uint8_t tlsf_heap::get_fragmentation() const
+{
+    return Free ? static_cast<uint8_t>(100 - get_largest_free() * 100 / Free) : 0;
+}
+//------------------------------------------------------------------------------
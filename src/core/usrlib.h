@@ -12,6 +12,11 @@
 #define USRLIB_H
 
 #include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <type_traits>
+#include <new>
+#include <cstddef>
 
 //------------------------------------------------------------------------------
 //
@@ -20,45 +25,74 @@
 //
 namespace usr
 {
-    // 定义的 TCbuf 类是一个线程安全的环形缓冲区实现，
+    // 定义的 cbuf 类是一个线程安全的环形缓冲区实现，
     // 主要用于进程间通信数据缓冲。
     // 它提供批量读写、单字节安全存取、缓冲区状态查询等功能，
     // 通过 volatile 计数器和指针循环管理实现高效内存复用，
-    // 最大支持256字节容量，被 TChannel 类引用作为内核级通信通道的底层存储容器。
-    class TCbuf
+    // 被 byte_channel 类引用作为内核级通信通道的底层存储容器。
+    // 索引类型 S 决定最大容量：uint8_t 为255字节（适用于小型目标），
+    // uint16_t/uint32_t 用于多KB缓冲区。批量读写以两段 memcpy 完成。
+    template<typename S>
+    class cbuf
     {
     public:
         /// @brief 构造函数，初始化环形缓冲区
         /// @param Address 缓冲区起始地址（需预先分配内存）
-        /// @param Size 缓冲区总容量（最大256字节）
-        TCbuf(uint8_t* const Address, const uint8_t Size);
+        /// @param Size 缓冲区总容量（不超过 S 的最大值）
+        cbuf(uint8_t* const Address, const S Size);
         
         /// @brief 批量写入字节数据
         /// @param data 源数据指针
         /// @param Count 要写入的字节数
         /// @return 写入成功返回true，缓冲区空间不足返回false
-        bool write(const uint8_t* data, const uint8_t Count);
+        bool write(const uint8_t* data, const S Count);
 
         /// @brief 批量读取字节数据（自动更新缓冲区状态）
         /// @param data 目标缓冲区指针
         /// @param Count 请求读取的字节数（实际读取数不超过可用数据量）
-        void read(uint8_t* const data, const uint8_t Count);
+        void read(uint8_t* const data, const S Count);
 
         /// @brief 获取当前存储的字节数
-        uint8_t get_count() const { return count; }
+        S get_count() const { return count; }
 
         /// @brief 获取剩余可用空间
-        uint8_t get_free_size() const { return size - count; }
+        S get_free_size() const { return size - count; }
+
+        /// @brief 获取缓冲区总容量
+        S get_size() const { return size; }
 
         /// @brief 随机访问缓冲区内容（不修改缓冲区状态）
         /// @param index 相对偏移量（0=最早写入的字节）
         /// @return 指定位置的字节值
         /// @warning 索引超出实际数据范围时将返回无效值
-        uint8_t get_byte(const uint8_t index) const;
+        uint8_t get_byte(const S index) const;
+
+        /// @brief 查找字节（按两个连续区段调用 memchr，不修改缓冲区状态）
+        /// @param c 要查找的字节值
+        /// @param from 起始相对偏移量（0=最早写入的字节）
+        /// @return 首次出现的相对偏移量，未找到时返回 get_count()
+        S find(const uint8_t c, S from = 0) const;
 
         /// @brief 清空缓冲区（重置读写指针和计数器）
         void clear() { count = 0; last = first; }
 
+        /// @brief 缓冲区为空时将读写指针复位到起点，整个存储区成为连续空闲区域
+        void rewind() { if(!count) first = last = 0; }
+
+        /// @brief 获取从读指针开始的连续可读区域
+        /// @return 区域字节数（回绕时小于 get_count()）
+        S read_span(uint8_t*& ptr) const { ptr = buf + first; const S n = size - first; return count < n ? count : n; }
+
+        /// @brief 获取从写指针开始的连续空闲区域
+        /// @return 区域字节数（回绕时小于 get_free_size()）
+        S write_span(uint8_t*& ptr) const { ptr = buf + last; const S n = size - last; const S free = size - count; return free < n ? free : n; }
+
+        /// @brief 提交已写入写区域的 cnt 个字节
+        void commit_write(const S cnt) { last  = (size - last)  > cnt ? last  + cnt : cnt - (size - last);  count += cnt; }
+
+        /// @brief 释放已从读区域取走的 cnt 个字节
+        void commit_read(const S cnt)  { first = (size - first) > cnt ? first + cnt : cnt - (size - first); count -= cnt; }
+
         /// @brief 安全写入单个字节（线程安全版本）
         /// @return 写入成功返回true，缓冲区满返回false
         bool put(const uint8_t item);
@@ -78,11 +112,20 @@ namespace usr
 
     private:
         uint8_t* buf;     ///< 缓冲区内存指针
-        uint8_t  size;    ///< 缓冲区总容量
-        volatile uint8_t count;  ///< 当前数据量（volatile保证多线程可见性）
-        uint8_t  first;   ///< 读指针（下一个要读取的位置）
-        uint8_t  last;    ///< 写指针（下一个要写入的位置）
+        S        size;    ///< 缓冲区总容量
+        volatile S count; ///< 当前数据量（volatile保证多线程可见性）
+        S        first;   ///< 读指针（下一个要读取的位置）
+        S        last;    ///< 写指针（下一个要写入的位置）
     };
+
+    // 成员函数定义位于 usrlib.cpp，仅为以下索引类型实例化
+    extern template class cbuf<uint8_t>;
+    extern template class cbuf<uint16_t>;
+    extern template class cbuf<uint32_t>;
+
+    typedef cbuf<uint8_t>  TCbuf;     ///< 最大255字节
+    typedef cbuf<uint16_t> TCbuf16;   ///< 最大65535字节
+    typedef cbuf<uint32_t> TCbuf32;
     //------------------------------------------------------------------------------
 
 
@@ -92,12 +135,20 @@ namespace usr
     /// @tparam T 存储的元素类型
     /// @tparam Size 缓冲区容量（最大65535元素）
     /// @tparam S 索引类型（默认uint8_t，容量>255时应使用uint16_t）
-    /// @note 支持前后端双向操作，适用于嵌入式系统的数据缓冲
+    /// @note 支持前后端双向操作，适用于嵌入式系统的数据缓冲。
+    ///       Size 为2的幂时使用掩码代替比较进行回绕；
+    ///       T 可平凡复制时批量读写以两段 memcpy 完成。
+    ///       存储区未初始化：元素在入队时原地构造，出队时移出并析构，
+    ///       因此 T 无需默认构造，可以是只可移动类型
     template<typename T, uint16_t Size, typename S = uint8_t>
     class ring_buffer
     {
     public:
         ring_buffer() : Count(0), First(0), Last(0) { }
+        ~ring_buffer() { flush(); }
+
+        ring_buffer(const ring_buffer&) = delete;
+        ring_buffer& operator=(const ring_buffer&) = delete;
 
         //----------------------------------------------------------------
         /// @name 数据操作接口
@@ -116,21 +167,33 @@ namespace usr
 
         /// @brief 安全压入元素到缓冲区后端
         /// @return 操作成功返回true，缓冲区满返回false
-        bool push_back(const T item);
+        bool push_back(const T& item);
+        bool push_back(T&& item);
+
+        /// @brief 在缓冲区后端原地构造元素
+        /// @return 操作成功返回true，缓冲区满返回false
+        template<typename... Args>
+        bool emplace_back(Args&&... args);
 
         /// @brief 安全压入元素到缓冲区前端
         /// @return 操作成功返回true，缓冲区满返回false
-        bool push_front(const T item);
+        bool push_front(const T& item);
 
         /// @brief 从缓冲区前端弹出元素
-        /// @return 弹出的元素（缓冲区空时返回无效值）
+        /// @return 弹出的元素（缓冲区空时返回默认构造值）
         T pop_front();
 
         /// @brief 从缓冲区后端弹出元素
-        /// @return 弹出的元素（缓冲区空时返回无效值） 
+        /// @return 弹出的元素（缓冲区空时返回默认构造值）
         T pop_back();
 
-        bool push(const T item) { return push_back(item); }
+        /// @brief 弹出元素并移动赋值到 item（无临时对象）
+        /// @return 缓冲区空时返回false
+        bool pop_front(T& item) { if(!Count) return false; pop_item(item);      return true; }
+        bool pop_back (T& item) { if(!Count) return false; pop_item_back(item); return true; }
+
+        bool push(const T& item) { return push_back(item); }
+        bool push(T&& item)      { return push_back(static_cast<T&&>(item)); }
         T pop() { return pop_front(); }
 
         //----------------------------------------------------------------
@@ -148,23 +211,186 @@ namespace usr
         /// @warning 索引越界时将返回无效引用
         T& operator[](const S index);
         
-        /// @brief 清空缓冲区（重置指针和计数器）
-        void flush() { Count = 0; Last = First; }
+        /// @brief 清空缓冲区（析构所有元素，重置指针和计数器）
+        void flush();
+
+        /// @brief 丢弃前端 cnt 个元素（析构，不返回）
+        /// @param cnt 丢弃数量（不得超过 get_count()）
+        void drop_front(const S cnt);
+        /// @}
+
+        //----------------------------------------------------------------
+        /// @name 连续区域访问接口（原地读写，无需中间缓冲，仅限可平凡复制的 T）
+        /// @{
+
+        /// @brief 获取从读指针开始的连续可读区域
+        /// @param ptr 返回区域起始地址
+        /// @return 区域内元素数量（回绕时小于 get_count()）
+        S read_span(T*& ptr);
+
+        /// @brief 获取从写指针开始的连续空闲区域
+        /// @param ptr 返回区域起始地址
+        /// @return 区域内元素数量（回绕时小于 get_free_size()）
+        S write_span(T*& ptr);
+
+        /// @brief 提交已写入写区域的 cnt 个元素
+        void commit_write(const S cnt) { Last  = wrap(Last + cnt);  Count += cnt; }
+
+        /// @brief 释放已从读区域取走的 cnt 个元素
+        void commit_read(const S cnt)  { First = wrap(First + cnt); Count -= cnt; }
+
+        /// @brief 缓冲区为空时将读写指针复位到起点，整个存储区成为连续空闲区域
+        void rewind() { if(!Count) First = Last = 0; }
         /// @}
 
     private:
         //--------------------------------------------------------------
         // 内部实现方法（无安全检查）
-        void push_item(const T item);      ///< 后端快速压入
-        void push_item_front(const T item); ///< 前端快速压入
+        void push_item(const T& item);      ///< 后端快速压入
+        void push_item(T&& item);           ///< 后端快速压入（移动）
+        void push_item_front(const T& item);///< 前端快速压入
+        void pop_item(T& item);             ///< 前端快速弹出（移动赋值到 item）
+        void pop_item_back(T& item);        ///< 后端快速弹出（移动赋值到 item）
         T pop_item();       ///< 前端快速弹出
         T pop_item_back();  ///< 后端快速弹出
 
+        static constexpr bool POW2 = (Size & (Size - 1)) == 0;
+
+        /// @brief 将 [0, 2*Size) 范围内的索引回绕到 [0, Size)
+        static S wrap(const unsigned x)
+        {
+            if constexpr (POW2)
+                return x & (Size - 1);
+            else
+                return x < Size ? x : x - Size;
+        }
+
+        /// @brief 存储槽地址
+        T* slot(const S i) { return reinterpret_cast<T*>(Buf) + i; }
+
     private:
         S  Count;    ///< 当前元素计数
         S  First;    ///< 读指针（前端位置）
         S  Last;     ///< 写指针（后端位置）
-        T  Buf[Size];///< 数据存储数组
+        alignas(T) uint8_t Buf[Size * sizeof(T)];  ///< 未初始化的数据存储区
+    };
+    //------------------------------------------------------------------
+
+
+
+    //-----------------------------------------------------------------------
+    /// @brief 单生产者/单消费者无锁环形缓冲区
+    /// @tparam T 存储的元素类型
+    /// @tparam Size 缓冲区容量（必须为2的幂，最大32768元素）
+    /// @note Head 只由生产者写，Tail 只由消费者写，两端均无需临界区，
+    ///       生产者可以是 ISR，消费者可以是进程（或相反）
+    template<typename T, uint16_t Size>
+    class spsc_ring
+    {
+        static_assert(Size && !(Size & (Size - 1)), "spsc_ring: Size must be a power of two");
+        static_assert(Size <= 0x8000, "spsc_ring: Size must not exceed 32768");
+
+    public:
+        spsc_ring() : Head(0), Tail(0) { }
+
+        /// @name 生产者接口
+        /// @{
+        bool     push (const T& item);
+        /// @return 实际写入的元素数量（空间不足时截断）
+        uint16_t write(const T* data, const uint16_t cnt);
+        /// @}
+
+        /// @name 消费者接口
+        /// @{
+        bool     pop (T& item);
+        /// @return 实际读取的元素数量
+        uint16_t read(T* const data, const uint16_t cnt);
+        /// @}
+
+        uint16_t get_count()     const { return static_cast<uint16_t>(Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire)); }
+        uint16_t get_free_size() const { return Size - get_count(); }
+        bool     empty()         const { return get_count() == 0; }
+
+    private:
+        static constexpr uint16_t MASK = Size - 1;
+
+        std::atomic<uint16_t> Head;   ///< 写索引（自由增长，取模使用）
+        std::atomic<uint16_t> Tail;   ///< 读索引（自由增长，取模使用）
+        T  Buf[Size];                 ///< 数据存储数组
+    };
+    //------------------------------------------------------------------
+
+
+
+    struct tlsf_block;                                    ///< 块头，定义见 usrlib.cpp
+
+    //-----------------------------------------------------------------------
+    /// @brief TLSF（两级分离适配）堆分配器
+    /// @note malloc/free/realloc 均为 O(1)：空闲块按大小分入两级位图索引的
+    ///       链表，查找只需两次位扫描，释放时与相邻空闲块立即合并。
+    ///       块头开销为一个字，负载按 ALIGN 字节对齐。
+    ///       本类不含任何锁，多进程使用时由调用方加锁（参见 OS::THeap）。
+    ///       对象零初始化后即可调用 init()，因此可用作静态对象而不依赖构造顺序。
+    class tlsf_heap
+    {
+    public:
+        enum
+        {
+            ALIGN_LOG2 = 3,
+            ALIGN      = 1 << ALIGN_LOG2,                 ///< 负载对齐字节数
+            SL_LOG2    = 4,                               ///< 每级 16 个二级链表
+            FL_SHIFT   = SL_LOG2 + ALIGN_LOG2,
+            FL_MAX     = 24,                              ///< 最大块 16 MB
+            FL_COUNT   = FL_MAX - FL_SHIFT + 1,
+            SL_COUNT   = 1 << SL_LOG2,
+            SMALL_SIZE = 1 << FL_SHIFT
+        };
+
+        /// @brief 在 mem 开始的 size 字节上建立堆（mem 需按 ALIGN 对齐）
+        /// @return 区域过小时返回 false
+        bool   init(void* mem, size_t size);
+        bool   ready() const { return Total != 0; }
+
+        void*  malloc(size_t size);                       ///< 空间不足返回 0
+        void   free(void* ptr);                           ///< ptr 可为 0
+        void*  realloc(void* ptr, size_t size);           ///< 优先原地扩展/收缩
+        /// @brief 原地扩展/收缩 ptr 所指块
+        /// @return 无法原地满足时返回 false，块保持不变
+        bool   resize(void* ptr, size_t size);
+        static size_t usable_size(const void* ptr);       ///< ptr 所指块的负载字节数
+
+        /// @name 统计接口
+        /// @{
+        size_t get_used()      const { return Used; }     ///< 已分配字节数（含块头）
+        size_t get_free()      const { return Free; }     ///< 空闲字节数
+        size_t get_peak_used() const { return PeakUsed; } ///< 已分配字节数峰值
+        /// @brief 最大空闲块负载字节数的下界：最高非空链表的起始大小
+        /// @note O(1)，不遍历链表；该大小的 malloc() 必定成功，结果与实际
+        ///       最大空闲块至多相差一个二级链表的跨度（约 1/16）
+        size_t get_largest_free() const;
+        /// @brief 碎片率：1 - get_largest_free()/空闲总量，单位为百分比
+        uint8_t get_fragmentation() const;
+        /// @}
+
+    private:
+        typedef tlsf_block block;
+
+        void   insert(block* b);
+        void   remove(block* b);
+        void   remove(block* b, unsigned fl, unsigned sl);
+        block* find_free(size_t size);
+        block* merge_prev(block* b);
+        block* merge_next(block* b);
+        block* split(block* b, size_t size);
+        void*  use(block* b, size_t size);
+
+        uint32_t FlBitmap;                                ///< 非空一级链表组
+        uint32_t SlBitmap[FL_COUNT];                      ///< 各组内非空二级链表
+        block*  Blocks[FL_COUNT][SL_COUNT];               ///< 空闲链表头
+        size_t  Total;                                    ///< 堆区域大小，0 表示未初始化
+        size_t  Used;
+        size_t  Free;
+        size_t  PeakUsed;
     };
     //------------------------------------------------------------------
 } 
@@ -183,8 +409,18 @@ bool usr::ring_buffer<T, Size, S>::write(const T* data, const S cnt)
     if( cnt > (Size - Count) )
         return false;
 
-    for(S i = 0; i < cnt; i++)
-        push_item(*(data++));
+    if constexpr (std::is_trivially_copyable<T>::value)
+    {
+        const S n1 = (Size - Last) < cnt ? Size - Last : cnt;    // part up to the end of the buffer
+        memcpy(slot(Last), data, n1 * sizeof(T));
+        memcpy(slot(0), data + n1, (cnt - n1) * sizeof(T));
+        commit_write(cnt);
+    }
+    else
+    {
+        for(S i = 0; i < cnt; i++)
+            push_item(*(data++));
+    }
 
     return true;
 }
@@ -194,24 +430,74 @@ void usr::ring_buffer<T, Size, S>::read(T* data, const S cnt)
 {
     S nItems = cnt <= Count ? cnt : Count;
 
-    for(S i = 0; i < nItems; i++)
-        data[i] = pop_item();
+    if constexpr (std::is_trivially_copyable<T>::value)
+    {
+        const S n1 = (Size - First) < nItems ? Size - First : nItems;
+        memcpy(data, slot(First), n1 * sizeof(T));
+        memcpy(data + n1, slot(0), (nItems - n1) * sizeof(T));
+        commit_read(nItems);
+    }
+    else
+    {
+        for(S i = 0; i < nItems; i++)
+            pop_item(data[i]);
+    }
 }
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
-T& usr::ring_buffer<T, Size, S>::operator[](const S index)
+S usr::ring_buffer<T, Size, S>::read_span(T*& ptr)
 {
-    S x = First + index;
+    static_assert(std::is_trivially_copyable<T>::value, "ring_buffer: spans require trivially copyable T");
 
-    if(x < Size)
-        return Buf[x];
-    else
-        return Buf[x - Size];
+    ptr = slot(First);
+    const S n = Size - First;
+    return Count < n ? Count : n;
 }
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+S usr::ring_buffer<T, Size, S>::write_span(T*& ptr)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ring_buffer: spans require trivially copyable T");
 
+    ptr = slot(Last);
+    const S n    = Size - Last;
+    const S free = Size - Count;
+    return free < n ? free : n;
+}
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
-bool usr::ring_buffer<T, Size, S>::push_back(const T item)
+void usr::ring_buffer<T, Size, S>::flush()
+{
+    if constexpr (!std::is_trivially_destructible<T>::value)
+    {
+        for(S i = 0; i < Count; i++)
+            slot(wrap(First + i))->~T();
+    }
+    Count = 0;
+    Last  = First;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+void usr::ring_buffer<T, Size, S>::drop_front(const S cnt)
+{
+    if constexpr (!std::is_trivially_destructible<T>::value)
+    {
+        for(S i = 0; i < cnt; i++)
+            slot(wrap(First + i))->~T();
+    }
+    First  = wrap(First + cnt);
+    Count -= cnt;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+T& usr::ring_buffer<T, Size, S>::operator[](const S index)
+{
+    return *slot(wrap(First + index));
+}
+
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+bool usr::ring_buffer<T, Size, S>::push_back(const T& item)
 {
     if(Count == Size)
         return false;
@@ -221,7 +507,30 @@ bool usr::ring_buffer<T, Size, S>::push_back(const T item)
 }
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
-bool usr::ring_buffer<T, Size, S>::push_front(const T item)
+bool usr::ring_buffer<T, Size, S>::push_back(T&& item)
+{
+    if(Count == Size)
+        return false;
+
+    push_item(static_cast<T&&>(item));
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+template<typename... Args>
+bool usr::ring_buffer<T, Size, S>::emplace_back(Args&&... args)
+{
+    if(Count == Size)
+        return false;
+
+    new (slot(Last)) T(static_cast<Args&&>(args)...);
+    Last = wrap(Last + 1);
+    Count++;
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+bool usr::ring_buffer<T, Size, S>::push_front(const T& item)
 {
     if(Count == Size)
         return false;
@@ -236,7 +545,7 @@ T usr::ring_buffer<T, Size, S>::pop_front()
     if(Count)
         return pop_item();
     else
-        return Buf[First];
+        return T();
 }
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
@@ -245,40 +554,65 @@ T usr::ring_buffer<T, Size, S>::pop_back()
     if(Count)
         return pop_item_back();
     else
-        return Buf[First];
+        return T();
 }
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
-void usr::ring_buffer<T, Size, S>::push_item(const T item)
+void usr::ring_buffer<T, Size, S>::push_item(const T& item)
 {
-    Buf[Last] = item;
-    Last++;
+    new (slot(Last)) T(item);
+    Last = wrap(Last + 1);
     Count++;
-
-    if(Last == Size)
-        Last = 0;
 }
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
-void usr::ring_buffer<T, Size, S>::push_item_front(const T item)
+void usr::ring_buffer<T, Size, S>::push_item(T&& item)
 {
-    if(First == 0)
-        First = Size - 1;
-    else
-        --First;
-    Buf[First] = item;
+    new (slot(Last)) T(static_cast<T&&>(item));
+    Last = wrap(Last + 1);
     Count++;
 }
 //------------------------------------------------------------------------------
 template<typename T, uint16_t Size, typename S>
+void usr::ring_buffer<T, Size, S>::push_item_front(const T& item)
+{
+    First = wrap(First + Size - 1);
+    new (slot(First)) T(item);
+    Count++;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+void usr::ring_buffer<T, Size, S>::pop_item(T& item)
+{
+    T* p = slot(First);
+    item = static_cast<T&&>(*p);
+    p->~T();
+
+    Count--;
+    First = wrap(First + 1);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
+void usr::ring_buffer<T, Size, S>::pop_item_back(T& item)
+{
+    Last = wrap(Last + Size - 1);
+
+    T* p = slot(Last);
+    item = static_cast<T&&>(*p);
+    p->~T();
+
+    Count--;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S>
 T usr::ring_buffer<T, Size, S>::pop_item()
 {
-    T item = Buf[First];
+    T* p = slot(First);
+    T item(static_cast<T&&>(*p));
+    p->~T();
 
     Count--;
-    First++;
-    if(First == Size)
-        First = 0;
+    First = wrap(First + 1);
 
     return item;
 }
@@ -286,14 +620,74 @@ T usr::ring_buffer<T, Size, S>::pop_item()
 template<typename T, uint16_t Size, typename S>
 T usr::ring_buffer<T, Size, S>::pop_item_back()
 {
+    Last = wrap(Last + Size - 1);
 
-    if(Last == 0)
-        Last = Size - 1;
-    else
-        --Last;
+    T* p = slot(Last);
+    T item(static_cast<T&&>(*p));
+    p->~T();
 
     Count--;
-    return Buf[Last];;
+    return item;
+}
+//------------------------------------------------------------------------------
+
+
+//------------------------------------------------------------------------------
+//
+//    The SPSC ring function-member definitions
+//
+//
+//
+template<typename T, uint16_t Size>
+bool usr::spsc_ring<T, Size>::push(const T& item)
+{
+    const uint16_t h = Head.load(std::memory_order_relaxed);
+    if( static_cast<uint16_t>(h - Tail.load(std::memory_order_acquire)) == Size )
+        return false;
+
+    Buf[h & MASK] = item;
+    Head.store(h + 1, std::memory_order_release);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size>
+uint16_t usr::spsc_ring<T, Size>::write(const T* data, const uint16_t cnt)
+{
+    const uint16_t h    = Head.load(std::memory_order_relaxed);
+    const uint16_t free = Size - static_cast<uint16_t>(h - Tail.load(std::memory_order_acquire));
+    const uint16_t n    = cnt < free ? cnt : free;
+
+    for(uint16_t i = 0; i < n; i++)
+        Buf[(h + i) & MASK] = data[i];
+
+    Head.store(h + n, std::memory_order_release);
+    return n;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size>
+bool usr::spsc_ring<T, Size>::pop(T& item)
+{
+    const uint16_t t = Tail.load(std::memory_order_relaxed);
+    if( Head.load(std::memory_order_acquire) == t )
+        return false;
+
+    item = Buf[t & MASK];
+    Tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size>
+uint16_t usr::spsc_ring<T, Size>::read(T* const data, const uint16_t cnt)
+{
+    const uint16_t t     = Tail.load(std::memory_order_relaxed);
+    const uint16_t avail = static_cast<uint16_t>(Head.load(std::memory_order_acquire) - t);
+    const uint16_t n     = cnt < avail ? cnt : avail;
+
+    for(uint16_t i = 0; i < n; i++)
+        data[i] = Buf[(t + i) & MASK];
+
+    Tail.store(t + n, std::memory_order_release);
+    return n;
 }
 //------------------------------------------------------------------------------
 
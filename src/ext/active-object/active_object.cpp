@@ -0,0 +1,252 @@
+/**
+  ******************************************************************************
+  * @file           : active_object.cpp
+  * @author         : ruixuezhao
+  * @brief          : Active objects with run-to-completion event dispatch
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "active_object.h"
+
+namespace OS
+{
+
+void TEventPoolBase::release(const TEvent* e, bool isr)
+{
+    if( !e->Pool )
+        return;                                   // static event
+
+    TEvent* ev = const_cast<TEvent*>(e);
+    {
+        TCritSect cs;
+        if( ev->RefCount && --ev->RefCount )
+            return;
+    }
+    ev->Pool->FreeFn(ev->Pool, ev, isr);
+}
+
+
+
+bool TActiveObject::put(const TEvent* e)
+{
+    if( Count == Size )
+    {
+        ++Dropped;
+        return false;
+    }
+
+    uint16_t last = First + Count;
+    if( last >= Size )
+        last -= Size;
+    Queue[last] = e;
+    if( ++Count > HighWater )
+        HighWater = Count;
+
+    if( e->Pool )
+        ++const_cast<TEvent*>(e)->RefCount;
+    if( Count == 1 )
+        Worker.make_ready(this);
+    return true;
+}
+
+
+
+const TEvent* TActiveObject::get()
+{
+    const TEvent* e = Queue[First];
+    if( ++First == Size )
+        First = 0;
+    --Count;
+    return e;
+}
+
+
+
+bool TActiveObject::post(const TEvent* e)
+{
+    bool ok, orphan;
+    {
+        TCritSect cs;
+        ok = put(e);
+        if( ok )
+            Worker.wake();
+        // decided here: once the lock is released another worker may free a shared event
+        orphan = !ok && e->Pool && !e->RefCount;
+    }
+    if( orphan )
+        TEventPoolBase::release(e);               // nobody else holds it
+    return ok;
+}
+
+
+
+bool TActiveObject::post_isr(const TEvent* e)
+{
+    bool ok, orphan;
+    {
+        TCritSect cs;
+        ok = put(e);
+        if( ok )
+            Worker.wake_isr();
+        orphan = !ok && e->Pool && !e->RefCount;
+    }
+    if( orphan )
+        TEventPoolBase::release(e, true);
+    return ok;
+}
+
+
+
+void TActiveWorker::make_ready(TActiveObject* ao)
+{
+    ao->Next = 0;
+    if( ReadyTail )
+        ReadyTail->Next = ao;
+    else
+        ReadyHead = ao;
+    ReadyTail = ao;
+}
+
+
+
+bool TActiveWorker::run_once(timeout_t timeout)
+{
+    TActiveObject* ao;
+    const TEvent*  e;
+    {
+        TCritSect cs;
+
+        if( !ReadyHead )
+        {
+            cur_proc_timeout() = timeout;
+            do
+            {
+                // no pending events, suspend until posted or timeout
+                suspend(ProcessMap);
+                if( is_timeouted(ProcessMap) )
+                    return false;
+            }
+            while( !ReadyHead );
+            cur_proc_timeout() = 0;
+        }
+
+        ao = ReadyHead;
+        ReadyHead = ao->Next;
+        if( !ReadyHead )
+            ReadyTail = 0;
+
+        e = ao->get();
+        if( ao->Count )
+            make_ready(ao);                       // next event after the other objects' ones
+    }
+
+    ao->Dispatch(ao, e);                          // run to completion, interrupts enabled
+    {
+        TCritSect cs;
+        ++ao->Dispatched;
+    }
+    TEventPoolBase::release(e);
+    return true;
+}
+
+
+
+void TActiveWorker::run()
+{
+    for(;;)
+        run_once();
+}
+
+
+
+bool TEventBusBase::subscribe(TActiveObject& ao, TSignal sig)
+{
+    TCritSect cs;
+
+    if( sig >= SignalCount )
+        return false;
+
+    uint_fast8_t free_id = 32;
+    for(uint_fast8_t id = 0; id < 32; ++id)
+    {
+        if( Objects[id] == &ao )
+        {
+            Subscribers[sig] |= 1ul << id;
+            return true;
+        }
+        if( !Objects[id] && free_id == 32 )
+            free_id = id;
+    }
+    if( free_id == 32 )
+        return false;
+
+    Objects[free_id]  = &ao;
+    Subscribers[sig] |= 1ul << free_id;
+    return true;
+}
+
+
+
+void TEventBusBase::unsubscribe(TActiveObject& ao, TSignal sig)
+{
+    TCritSect cs;
+
+    if( sig >= SignalCount )
+        return;
+
+    for(uint_fast8_t id = 0; id < 32; ++id)
+    {
+        if( Objects[id] == &ao )
+            Subscribers[sig] &= ~(1ul << id);
+    }
+}
+
+
+
+void TEventBusBase::deliver(const TEvent* e, bool isr)
+{
+    if( e->Signal < SignalCount )
+    {
+        TCritSect cs;
+
+        // hold an extra reference, so early dispatch can't free the event
+        // before it is posted to all subscribers
+        if( e->Pool )
+            ++const_cast<TEvent*>(e)->RefCount;
+
+        uint32_t subs = Subscribers[e->Signal];
+        for(uint_fast8_t id = 0; subs; ++id, subs >>= 1)
+        {
+            if( (subs & 1) && Objects[id]->put(e) )
+            {
+                if( isr )
+                    Objects[id]->Worker.wake_isr();
+                else
+                    Objects[id]->Worker.wake();
+            }
+        }
+    }
+    else if( e->Pool )
+    {
+        TCritSect cs;
+        ++const_cast<TEvent*>(e)->RefCount;
+    }
+    TEventPoolBase::release(e, isr);              // frees it if nobody subscribed
+}
+
+
+
+void TEventBusBase::publish(const TEvent* e)
+{
+    deliver(e, false);
+}
+
+
+
+void TEventBusBase::publish_isr(const TEvent* e)
+{
+    deliver(e, true);
+}
+
+} // ns OS
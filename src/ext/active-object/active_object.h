@@ -0,0 +1,229 @@
+/**
+  ******************************************************************************
+  * @file           : active_object.h
+  * @author         : ruixuezhao
+  * @brief          : Active objects with run-to-completion event dispatch
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef ACTIVE_OBJECT_H
+#define ACTIVE_OBJECT_H
+#include "vortexRT.h"
+#include <vortex/ext/mem-pool/mem_pool.h>
+#include <new>
+namespace OS
+{
+
+class TActiveObject;
+class TEventPoolBase;
+
+typedef uint16_t TSignal;
+
+//------------------------------------------------------------------------------
+//
+//   TEvent
+//
+//   Base of all events. Events with parameters derive from it. Static
+//   (const) events have no pool and are never freed; pooled events are
+//   reference counted and return to their pool after the last subscriber
+//   has dispatched them.
+//
+struct TEvent
+{
+    TEvent(TSignal sig = 0) : Signal(sig), RefCount(0), Pool(0) { }
+
+    TSignal           Signal;
+    volatile uint8_t  RefCount;
+    TEventPoolBase*   Pool;
+};
+
+//------------------------------------------------------------------------------
+//
+//   Event pools
+//
+class TEventPoolBase
+{
+public:
+    typedef void (*TFree)(TEventPoolBase* self, TEvent* e, bool isr);
+
+    TEventPoolBase(TFree f) : FreeFn(f) { }
+
+    // drops a reference, the event returns to its pool after the last one
+    static void release(const TEvent* e, bool isr = false);
+
+protected:
+    TFree FreeFn;
+};
+
+template<typename E, uint16_t Count>
+class event_pool : public TEventPoolBase
+{
+public:
+    event_pool() : TEventPoolBase(&free_event) { }
+
+    E* alloc    (TSignal sig, timeout_t timeout = 0) { return init(Pool.alloc(timeout), sig); }   // 0 on timeout
+    E* alloc_isr(TSignal sig)                        { return init(Pool.try_alloc(), sig);    }   // 0 if pool is empty
+
+    INLINE const TMemPool<sizeof(E), Count>& pool() const { return Pool; }                          // statistics
+
+protected:
+    E* init(void* block, TSignal sig)
+    {
+        if(!block)
+            return 0;
+        E* e = new (block) E();
+        e->Signal = sig;
+        e->Pool   = this;
+        return e;
+    }
+
+    static void free_event(TEventPoolBase* self, TEvent* e, bool isr)
+    {
+        event_pool* p = static_cast<event_pool*>(self);
+        static_cast<E*>(e)->~E();
+        if(isr)
+            p->Pool.free_isr(e);
+        else
+            p->Pool.free(e);
+    }
+
+    TMemPool<sizeof(E), Count> Pool;
+};
+
+//------------------------------------------------------------------------------
+//
+//   TActiveWorker
+//
+//   Process-side engine shared by active objects of one priority. The user
+//   process calls run() from its exec(); the worker takes one event at a
+//   time from the active objects that have pending events, in round-robin
+//   order, and dispatches it to completion. Only the worker's process needs
+//   a stack, idle active objects cost just their queues.
+//
+class TActiveWorker : protected TService
+{
+public:
+    TActiveWorker() : ProcessMap(0), ReadyHead(0), ReadyTail(0) { }
+
+    NORETURN void run();
+    bool run_once(timeout_t timeout = 0);       // dispatches one event; false on timeout
+
+protected:
+    friend class TActiveObject;
+    friend class TEventBusBase;
+
+    void make_ready(TActiveObject* ao);         // call in critical section
+    void wake()     { resume_all(ProcessMap);     }
+    void wake_isr() { resume_all_isr(ProcessMap); }
+
+    volatile TProcessMap ProcessMap;
+    TActiveObject*       ReadyHead;             // objects with pending events
+    TActiveObject*       ReadyTail;
+};
+
+//------------------------------------------------------------------------------
+//
+//   TActiveObject
+//
+//   Event queue plus dispatch function. Derive from active_object<> below
+//   rather than from this class directly.
+//
+class TActiveObject
+{
+public:
+    typedef void (*TDispatch)(TActiveObject* self, const TEvent* e);
+
+    bool post    (const TEvent* e);             // false if the queue is full - event is dropped
+    bool post_isr(const TEvent* e);
+
+    // statistics
+    INLINE uint16_t get_count()      const { TCritSect cs; return Count;      }
+    INLINE uint16_t get_high_water() const { TCritSect cs; return HighWater;  }
+    INLINE uint32_t get_dispatched() const { TCritSect cs; return Dispatched; }
+    INLINE uint32_t get_dropped()    const { TCritSect cs; return Dropped;    }
+
+protected:
+    TActiveObject(TActiveWorker& w, TDispatch d, const TEvent** buf, uint16_t size)
+        : Worker(w), Dispatch(d), Next(0), Queue(buf), Size(size)
+        , First(0), Count(0), HighWater(0), Dispatched(0), Dropped(0)
+    {
+    }
+
+    friend class TActiveWorker;
+    friend class TEventBusBase;
+
+    bool         put(const TEvent* e);          // call in critical section
+    const TEvent* get();                        // call in critical section
+
+    TActiveWorker&  Worker;
+    TDispatch       Dispatch;
+    TActiveObject*  Next;                       // worker's ready list
+
+    const TEvent**  Queue;
+    uint16_t        Size;
+    uint16_t        First;
+    uint16_t        Count;
+    uint16_t        HighWater;
+    uint32_t        Dispatched;
+    uint32_t        Dropped;
+};
+
+//------------------------------------------------------------------------------
+//
+//   Active object with QueueSize event slots. Derived must provide
+//
+//       void dispatch(const OS::TEvent* e);
+//
+//   which is called in the worker's process for every event, one at a time.
+//
+template<typename Derived, uint16_t QueueSize>
+class active_object : public TActiveObject
+{
+public:
+    active_object(TActiveWorker& w) : TActiveObject(w, &thunk, Buf, QueueSize) { }
+
+private:
+    static void thunk(TActiveObject* self, const TEvent* e) { static_cast<Derived*>(self)->dispatch(e); }
+
+    const TEvent* Buf[QueueSize];
+};
+
+//------------------------------------------------------------------------------
+//
+//   Publish/subscribe
+//
+//   Signals below SignalCount may be published to all active objects that
+//   subscribed to them; up to 32 subscribers per bus.
+//
+class TEventBusBase
+{
+public:
+    bool subscribe  (TActiveObject& ao, TSignal sig);   // false if the bus is full
+    void unsubscribe(TActiveObject& ao, TSignal sig);
+
+    void publish    (const TEvent* e);
+    void publish_isr(const TEvent* e);
+
+protected:
+    TEventBusBase(uint32_t* subs, TSignal count) : Subscribers(subs), SignalCount(count), Objects() { }
+
+    void deliver(const TEvent* e, bool isr);
+
+    uint32_t*      Subscribers;                 // subscriber bitmap per signal
+    TSignal        SignalCount;
+    TActiveObject* Objects[32];
+};
+
+template<TSignal Signals>
+class event_bus : public TEventBusBase
+{
+public:
+    event_bus() : TEventBusBase(Subs, Signals), Subs() { }
+private:
+    uint32_t Subs[Signals];
+};
+
+} // ns OS
+
+#endif /* ACTIVE_OBJECT_H */
@@ -0,0 +1,279 @@
+/**
+  ******************************************************************************
+  * @file           : broadcast_channel.h
+  * @author         : ruixuezhao
+  * @brief          : One producer, many readers ring with per-reader cursors
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef BROADCAST_CHANNEL_H
+#define BROADCAST_CHANNEL_H
+#include "vortexRT.h"
+namespace OS
+{
+
+enum TBroadcastPolicy
+{
+    bpBlock,                                    // producer waits for the slowest reader
+    bpOverwrite                                 // producer never waits, lagging readers lose samples
+};
+
+//------------------------------------------------------------------------------
+//
+//   broadcast_channel
+//
+//   Every sample is written once by the single producer and read in place by
+//   each subscribed reader. Readers own independent sequence cursors, so the
+//   ring is shared instead of keeping one channel copy per consumer.
+//
+//   Producer: claim() returns the slot to fill, publish() makes it visible to
+//   all readers. push() does both with a copy.
+//
+//   Reader: subscribe() returns a reader id whose cursor starts at the next
+//   published sample. peek() returns the oldest unread sample in place,
+//   consume() advances the cursor.
+//
+//   bpBlock:     claim() waits while the slowest active reader lags Size
+//                samples behind.
+//   bpOverwrite: claim() never waits. A reader that has fallen behind is
+//                moved forward on its next peek(), skipped samples are
+//                counted by lost(). Reader may lag at most Size-1 samples, and
+//                consume() returns false if the sample was overwritten while
+//                the reader was processing it in place.
+//
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy = bpBlock>
+class broadcast_channel : protected TService
+{
+    static_assert(Size >= 2 && (Size & (Size - 1)) == 0, "broadcast_channel size must be a power of two");
+    static_assert(Readers >= 1 && Readers <= 32, "broadcast_channel supports 1..32 readers");
+
+public:
+    INLINE broadcast_channel()
+        : ProducersProcessMap(0)
+        , ConsumersProcessMap(0)
+        , WriteSeq(0)
+        , ActiveMask(0)
+        , Cursor()
+        , Lost()
+    {
+    }
+
+    uint_fast8_t subscribe();                           // returns Readers if no free reader slot
+    void         unsubscribe(uint_fast8_t id);
+
+    // producer side
+    T*   claim  (timeout_t timeout = 0);                // returns 0 on timeout
+    void publish();
+    bool push   (const T& item, timeout_t timeout = 0); // false on timeout
+    bool push_isr(const T& item);                       // false if bpBlock and the ring is full
+
+    // reader side
+    const T* peek   (uint_fast8_t id, timeout_t timeout = 0);   // returns 0 on timeout
+    bool     consume(uint_fast8_t id);
+    bool     read   (uint_fast8_t id, T& item, timeout_t timeout = 0);
+
+    INLINE uint16_t get_count(uint_fast8_t id) const { TCritSect cs; return WriteSeq - Cursor[id]; }
+    INLINE uint32_t lost(uint_fast8_t id)      const { TCritSect cs; return Lost[id]; }
+
+protected:
+    enum { MASK = Size - 1 };
+
+    bool     ring_full() const;
+    bool     wait_data(uint_fast8_t id, timeout_t timeout);
+    void     catch_up(uint_fast8_t id);
+
+    volatile TProcessMap ProducersProcessMap;
+    volatile TProcessMap ConsumersProcessMap;
+
+    uint32_t WriteSeq;                                  // sequence of the next sample to publish
+    uint32_t ActiveMask;                                // subscribed readers
+    uint32_t Cursor[Readers];                           // sequence of the next sample to read
+    uint32_t Lost[Readers];                             // overwritten samples, bpOverwrite only
+    T        Buf[Size];
+};
+
+//------------------------------------------------------------------------------
+//
+//       broadcast_channel function-members implementation
+//
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+uint_fast8_t broadcast_channel<T, Size, Readers, Policy>::subscribe()
+{
+    TCritSect cs;
+
+    for(uint_fast8_t id = 0; id < Readers; ++id)
+    {
+        if( !(ActiveMask & (1ul << id)) )
+        {
+            ActiveMask |= 1ul << id;
+            Cursor[id]  = WriteSeq;
+            Lost[id]    = 0;
+            return id;
+        }
+    }
+    return Readers;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+void broadcast_channel<T, Size, Readers, Policy>::unsubscribe(uint_fast8_t id)
+{
+    TCritSect cs;
+
+    ActiveMask &= ~(1ul << id);
+    if(ProducersProcessMap)
+        resume_all(ProducersProcessMap);            // that reader might be the slowest one
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+bool broadcast_channel<T, Size, Readers, Policy>::ring_full() const
+{
+    if(Policy == bpOverwrite)
+        return false;
+
+    for(uint_fast8_t id = 0; id < Readers; ++id)
+    {
+        if( (ActiveMask & (1ul << id)) && WriteSeq - Cursor[id] >= Size )
+            return true;
+    }
+    return false;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+T* broadcast_channel<T, Size, Readers, Policy>::claim(timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( ring_full() )
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // the slowest reader still holds the slot, suspend until it is consumed or timeout
+            suspend(ProducersProcessMap);
+            if(is_timeouted(ProducersProcessMap))
+                return 0;
+        }
+        while( ring_full() );
+        cur_proc_timeout() = 0;
+    }
+    return &Buf[WriteSeq & MASK];
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+void broadcast_channel<T, Size, Readers, Policy>::publish()
+{
+    TCritSect cs;
+
+    ++WriteSeq;
+    if(ConsumersProcessMap)
+        resume_all(ConsumersProcessMap);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+bool broadcast_channel<T, Size, Readers, Policy>::push(const T& item, timeout_t timeout)
+{
+    T* slot = claim(timeout);
+    if(!slot)
+        return false;
+
+    *slot = item;
+    publish();
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+bool broadcast_channel<T, Size, Readers, Policy>::push_isr(const T& item)
+{
+    TCritSect cs;
+
+    if( ring_full() )
+        return false;
+
+    Buf[WriteSeq & MASK] = item;
+    ++WriteSeq;
+    if(ConsumersProcessMap)
+        resume_all_isr(ConsumersProcessMap);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+void broadcast_channel<T, Size, Readers, Policy>::catch_up(uint_fast8_t id)
+{
+    // slot WriteSeq & MASK may be being filled by the producer, so a reader
+    // keeps at most Size-1 samples in bpOverwrite mode
+    if(Policy == bpOverwrite && WriteSeq - Cursor[id] >= Size)
+    {
+        const uint32_t oldest = WriteSeq - (Size - 1);
+        Lost[id]  += oldest - Cursor[id];
+        Cursor[id] = oldest;
+    }
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+bool broadcast_channel<T, Size, Readers, Policy>::wait_data(uint_fast8_t id, timeout_t timeout)
+{
+    if(Cursor[id] != WriteSeq)
+        return true;
+
+    cur_proc_timeout() = timeout;
+    do
+    {
+        // nothing new for this reader, suspend until published or timeout
+        suspend(ConsumersProcessMap);
+        if(is_timeouted(ConsumersProcessMap))
+            return false;
+    }
+    while(Cursor[id] == WriteSeq);
+    cur_proc_timeout() = 0;
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+const T* broadcast_channel<T, Size, Readers, Policy>::peek(uint_fast8_t id, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( !wait_data(id, timeout) )
+        return 0;
+
+    catch_up(id);
+    return &Buf[Cursor[id] & MASK];
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+bool broadcast_channel<T, Size, Readers, Policy>::consume(uint_fast8_t id)
+{
+    TCritSect cs;
+
+    if(Cursor[id] == WriteSeq)
+        return false;
+
+    const bool intact = Policy == bpBlock || WriteSeq - Cursor[id] < Size;
+    ++Cursor[id];
+    if(ProducersProcessMap)
+        resume_all(ProducersProcessMap);
+    return intact;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, uint_fast8_t Readers, TBroadcastPolicy Policy>
+bool broadcast_channel<T, Size, Readers, Policy>::read(uint_fast8_t id, T& item, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( !wait_data(id, timeout) )
+        return false;
+
+    catch_up(id);
+    item = Buf[Cursor[id] & MASK];
+    ++Cursor[id];
+    if(ProducersProcessMap)
+        resume_all(ProducersProcessMap);
+    return true;
+}
+//------------------------------------------------------------------------------
+
+} // ns OS
+
+#endif /* BROADCAST_CHANNEL_H */
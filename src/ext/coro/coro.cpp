@@ -0,0 +1,157 @@
+/**
+  ******************************************************************************
+  * @file           : coro.cpp
+  * @author         : ruixuezhao
+  * @brief          : C++20 coroutine executor running inside one process
+  * @attention      : Requires C++20 coroutines and system ticks
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "coro.h"
+
+#if defined(__cpp_impl_coroutine)
+
+namespace OS
+{
+
+void co_awaiter::await_suspend(co_task::handle_t h)
+{
+    Handle = h;
+    if(Timeout)
+        Deadline = get_tick_count() + Timeout;
+    h.promise().Executor->park(this);
+}
+
+
+
+void TCoroExecutor::spawn(co_task&& task)
+{
+    co_task::promise_type& p = task.Handle.promise();
+    task.Handle = 0;                              // executor owns the frame now
+
+    p.Executor = this;
+    {
+        TCritSect cs;
+        ++Count;
+        make_ready(&p);
+    }
+    notify();
+}
+
+
+
+void TCoroExecutor::make_ready(co_task::promise_type* p)
+{
+    p->Next = 0;
+    if(ReadyTail)
+        ReadyTail->Next = p;
+    else
+        ReadyHead = p;
+    ReadyTail = p;
+}
+
+
+
+void TCoroExecutor::park(co_awaiter* a)
+{
+    a->Next = Waiting;
+    Waiting = a;
+}
+
+
+
+void TCoroExecutor::resume(std::coroutine_handle<> h)
+{
+    h.resume();
+    if(h.done())
+    {
+        h.destroy();
+        TCritSect cs;
+        --Count;
+    }
+}
+
+
+
+bool TCoroExecutor::run_once()
+{
+    bool resumed = false;
+
+    // newly spawned coroutines; those spawned meanwhile run on the next pass
+    co_task::promise_type* p;
+    {
+        TCritSect cs;
+        p = ReadyHead;
+        ReadyHead = ReadyTail = 0;
+    }
+    while(p)
+    {
+        co_task::promise_type* next = p->Next;
+        resume(co_task::handle_t::from_promise(*p));
+        resumed = true;
+        p = next;
+    }
+
+    // waiting coroutines; awaiters parked by resumed ones are checked next pass
+    const tick_count_t now = get_tick_count();
+    co_awaiter* list = Waiting;
+    Waiting = 0;
+    while(list)
+    {
+        co_awaiter* a = list;
+        list = a->Next;
+
+        bool ready = a->Poll(a);
+        if(!ready && a->Timeout && static_cast<int32_t>(now - a->Deadline) >= 0)
+        {
+            a->TimedOut = true;
+            ready = true;
+        }
+
+        if(ready)
+        {
+            resume(a->Handle);
+            resumed = true;
+        }
+        else
+        {
+            park(a);
+        }
+    }
+    return resumed;
+}
+
+
+
+timeout_t TCoroExecutor::idle_timeout() const
+{
+    const tick_count_t now = get_tick_count();
+    timeout_t timeout = 0;
+    for(const co_awaiter* a = Waiting; a; a = a->Next)
+    {
+        if(a->Poll != &co_sleep::never)
+            return 1;                             // polled condition, check it on next tick
+
+        const int32_t left = static_cast<int32_t>(a->Deadline - now);
+        if(left <= 0)
+            return 1;                             // expired since the last pass
+        if(!timeout || left < timeout)
+            timeout = static_cast<timeout_t>(left);
+    }
+    return timeout;
+}
+
+
+
+void TCoroExecutor::run()
+{
+    for(;;)
+    {
+        if( !run_once() )
+            Wake.wait(idle_timeout());            // until notify(), a poll tick or the earliest deadline
+    }
+}
+
+} // ns OS
+
+#endif // __cpp_impl_coroutine
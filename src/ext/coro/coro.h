@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file           : coro.h
+  * @author         : ruixuezhao
+  * @brief          : C++20 coroutine executor running inside one process
+  * @attention      : Requires C++20 coroutines and system ticks
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef CORO_H
+#define CORO_H
+#include "vortexRT.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+
+#if vortexRT_SYSTEM_TICKS_ENABLE != 1
+#error "coroutine executor requires vortexRT_SYSTEM_TICKS_ENABLE == 1"
+#endif
+
+namespace OS
+{
+
+class TCoroExecutor;
+
+//------------------------------------------------------------------------------
+//
+//   co_task
+//
+//   Return type of a coroutine run by TCoroExecutor:
+//
+//       OS::co_task blink(OS::channel<int, 8>& ch)
+//       {
+//           for(;;)
+//           {
+//               int cmd;
+//               if(co_await OS::co_pop(ch, cmd, 100)) ...
+//               co_await OS::co_sleep(10);
+//           }
+//       }
+//
+//       Executor.spawn(blink(Cmd));
+//
+//   The coroutine starts when the executor first runs it, its frame is
+//   destroyed when it finishes. Frames come from operator new - see the
+//   tlsf-heap extension for a deterministic one. A coroutine can't co_await
+//   another co_task, spawn it instead.
+//
+class co_task
+{
+public:
+    struct promise_type
+    {
+        promise_type() : Executor(0), Next(0) { }
+
+        co_task get_return_object() { return co_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept   { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+
+        TCoroExecutor* Executor;
+        promise_type*  Next;                    // executor's ready list
+    };
+
+    typedef std::coroutine_handle<promise_type> handle_t;
+
+    co_task(co_task&& other) : Handle(other.Handle) { other.Handle = 0; }
+    ~co_task() { if(Handle) Handle.destroy(); }
+
+    co_task(const co_task&) = delete;
+    co_task& operator=(const co_task&) = delete;
+    co_task& operator=(co_task&&) = delete;
+
+private:
+    friend class TCoroExecutor;
+    explicit co_task(handle_t h) : Handle(h) { }
+
+    handle_t Handle;
+};
+
+//------------------------------------------------------------------------------
+//
+//   Base of all awaitables: a suspended coroutine waits in the executor's
+//   list until poll() reports that the awaited condition holds or the
+//   deadline passes. Timeout 0 means "no timeout", as for kernel services.
+//
+class co_awaiter
+{
+public:
+    typedef bool (*TPoll)(co_awaiter* self);
+
+    co_awaiter(TPoll poll, timeout_t timeout) : Poll(poll), Timeout(timeout), TimedOut(false), Next(0), Deadline(0) { }
+
+    void await_suspend(co_task::handle_t h);
+
+protected:
+    friend class TCoroExecutor;
+
+    TPoll                   Poll;
+    timeout_t               Timeout;
+    bool                    TimedOut;
+    co_awaiter*             Next;
+    tick_count_t            Deadline;
+    std::coroutine_handle<> Handle;
+};
+
+//------------------------------------------------------------------------------
+//
+//   TCoroExecutor
+//
+//   Runs any number of coroutines inside the process that calls run(), e.g.
+//   from its exec(). Ready coroutines are resumed in spawn/wake-up order;
+//   awaited kernel objects are polled on each pass. While nothing is ready
+//   the process waits for notify(): with no waiting coroutines forever, with
+//   only co_sleep waiters until the earliest deadline. Kernel objects don't
+//   know the executor, so while any coroutine awaits one the process also
+//   wakes every system tick to poll it - producers that feed coroutines may
+//   call notify()/notify_isr() to cut this up-to-one-tick latency.
+//
+//   spawn() may be called from any process: the ready list is shared with
+//   the executor process and updated in critical sections. Coroutine frames
+//   are allocated by the caller, so ISRs can't spawn.
+//
+class TCoroExecutor
+{
+public:
+    TCoroExecutor() : ReadyHead(0), ReadyTail(0), Waiting(0), Count(0) { }
+
+    void spawn(co_task&& task);                 // from any process
+    NORETURN void run();
+    bool run_once();                            // one pass, true if any coroutine was resumed
+
+    INLINE void notify()     { Wake.signal();     }
+    INLINE void notify_isr() { Wake.signal_isr(); }
+
+    INLINE uint16_t get_count() const { TCritSect cs; return Count; }
+
+protected:
+    friend class co_awaiter;
+
+    void make_ready(co_task::promise_type* p);  // call in critical section
+    void park(co_awaiter* a);
+    void resume(std::coroutine_handle<> h);
+    timeout_t idle_timeout() const;             // how long run() may wait for notify(), 0 - forever
+
+    co_task::promise_type* ReadyHead;
+    co_task::promise_type* ReadyTail;
+    co_awaiter*            Waiting;
+    uint16_t               Count;
+    TEventFlag             Wake;
+};
+
+//------------------------------------------------------------------------------
+//
+//   Awaitables
+//
+//------------------------------------------------------------------------------
+// resumes the coroutine after timeout ticks
+struct co_sleep : co_awaiter
+{
+    explicit co_sleep(timeout_t ticks) : co_awaiter(&never, ticks) { }
+    bool await_ready() const { return Timeout == 0; }
+    void await_resume() const { }
+
+    static bool never(co_awaiter*) { return false; }
+};
+
+// lets other ready coroutines run
+struct co_yield_now : co_awaiter
+{
+    co_yield_now() : co_awaiter(&always, 0) { }
+    bool await_ready() const { return false; }
+    void await_resume() const { }
+
+    static bool always(co_awaiter*) { return true; }
+};
+
+// waits for the event flag and clears it; false on timeout. The flag is
+// polled, so a signal is seen up to one tick late unless notify() follows it
+struct co_wait : co_awaiter
+{
+    co_wait(TEventFlag& ef, timeout_t timeout = 0) : co_awaiter(&poll, timeout), Flag(ef) { }
+    bool await_ready() { return poll(this); }
+    bool await_resume() const { return !TimedOut; }
+
+    static bool poll(co_awaiter* a)
+    {
+        TEventFlag& ef = static_cast<co_wait*>(a)->Flag;
+        if(!ef.is_signaled())
+            return false;
+        ef.clear();
+        return true;
+    }
+
+    TEventFlag& Flag;
+};
+
+// takes an item from the channel; false on timeout. The channel is polled,
+// so an item is taken up to one tick late unless notify() follows the push
+template<typename Channel, typename T>
+struct co_pop_awaiter : co_awaiter
+{
+    co_pop_awaiter(Channel& ch, T& item, timeout_t timeout) : co_awaiter(&poll, timeout), Chan(ch), Item(item) { }
+    bool await_ready() { return poll(this); }
+    bool await_resume() const { return !TimedOut; }
+
+    static bool poll(co_awaiter* a)
+    {
+        co_pop_awaiter* self = static_cast<co_pop_awaiter*>(a);
+        return self->Chan.try_pop(self->Item);
+    }
+
+    Channel& Chan;
+    T&       Item;
+};
+
+template<typename Channel, typename T>
+INLINE co_pop_awaiter<Channel, T> co_pop(Channel& ch, T& item, timeout_t timeout = 0)
+{
+    return co_pop_awaiter<Channel, T>(ch, item, timeout);
+}
+
+// waits until pred() returns true - any kernel object state can be awaited
+// this way, e.g. [&]{ return Msg.is_non_empty(); }; false on timeout. Like
+// the other polled awaitables, it sees a change up to one tick late
+// unless notify() follows it
+template<typename Pred>
+struct co_until : co_awaiter
+{
+    co_until(Pred pred, timeout_t timeout = 0) : co_awaiter(&poll, timeout), Cond(pred) { }
+    bool await_ready() { return Cond(); }
+    bool await_resume() const { return !TimedOut; }
+
+    static bool poll(co_awaiter* a) { return static_cast<co_until*>(a)->Cond(); }
+
+    Pred Cond;
+};
+
+} // ns OS
+
+#endif // __cpp_impl_coroutine
+
+#endif /* CORO_H */
@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file           : future.cpp
+  * @author         : ruixuezhao
+  * @brief          : Futures and promises for asynchronous completion
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "future.h"
+
+namespace OS
+{
+
+TFutureState::TFutureState(TFree f, void* pool)
+    : Pool(pool), ThenFn(0), ThenContext(0), FreeFn(f), ProcessMap(0)
+    , Status(fsEmpty), Refs(1), Listener(0), Queue(0), Thunk(0)
+    , Continuation(&run_then, this)
+{
+}
+
+
+
+bool TFutureState::wait(timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( Status == fsEmpty )
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            suspend(ProcessMap);
+            if( is_timeouted(ProcessMap) )
+                return false;
+        }
+        while( Status == fsEmpty );
+        cur_proc_timeout() = 0;
+    }
+    return true;
+}
+
+
+
+void TFutureState::complete(TStatus status, bool isr)
+{
+    TCritSect cs;
+
+    Status = status;
+    if( Listener )
+    {
+        if( isr )
+            Listener->signal_isr();
+        else
+            Listener->signal();
+    }
+    if( Queue )
+    {
+        if( isr )
+            Queue->submit_isr(Continuation);
+        else
+            Queue->submit(Continuation);
+    }
+    if( isr )
+        resume_all_isr(ProcessMap);
+    else
+        resume_all(ProcessMap);
+}
+
+
+
+void TFutureState::release(bool isr)
+{
+    {
+        TCritSect cs;
+        if( --Refs )
+            return;
+    }
+    FreeFn(this, isr);
+}
+
+
+
+bool TFutureState::attach(TEventFlag* listener)
+{
+    TCritSect cs;
+
+    if( Status != fsEmpty )
+        return false;
+    Listener = listener;
+    return true;
+}
+
+
+
+bool TFutureState::set_then(TWorkQueue& q, TThunk thunk, void (*fn)(), void* ctx)
+{
+    TCritSect cs;
+
+    if( Queue )
+        return false;                             // one continuation per state
+
+    Thunk       = thunk;
+    ThenFn      = fn;
+    ThenContext = ctx;
+    Queue       = &q;
+    if( Status != fsEmpty )
+        q.submit(Continuation);                   // already completed
+    return true;
+}
+
+
+
+void TFutureState::run_then(void* self)
+{
+    TFutureState* s = static_cast<TFutureState*>(self);
+    s->Thunk(s);
+    s->release();                                 // reference taken over from the future
+}
+
+
+
+bool when_all(TFutureBase* const futures[], uint_fast8_t count, timeout_t timeout)
+{
+    TEventFlag flag;
+    const tick_count_t deadline = get_tick_count() + timeout;
+
+    for(uint_fast8_t i = 0; i < count; )
+    {
+        TFutureState* s = futures[i]->state();
+        if( !s || !s->attach(&flag) )
+        {
+            ++i;                                  // ready or invalid
+            continue;
+        }
+
+        timeout_t left = 0;
+        if( timeout )
+        {
+            const int32_t rest = static_cast<int32_t>(deadline - get_tick_count());
+            if( rest <= 0 )
+            {
+                s->detach();
+                return false;
+            }
+            left = rest;
+        }
+        flag.wait(left);                          // the same future is checked again
+        s->detach();
+    }
+    return true;
+}
+
+
+
+int_fast8_t when_any(TFutureBase* const futures[], uint_fast8_t count, timeout_t timeout)
+{
+    TEventFlag flag;
+    int_fast8_t ready    = -1;
+    int_fast8_t invalid  = -1;
+    bool        attached = false;
+
+    for(uint_fast8_t i = 0; i < count && ready < 0; ++i)
+    {
+        TFutureState* s = futures[i]->state();
+        if( !s )
+        {
+            if( invalid < 0 )
+                invalid = i;
+        }
+        else if( s->attach(&flag) )
+            attached = true;
+        else
+            ready = i;
+    }
+
+    if( ready < 0 && !attached )
+        return invalid;                           // nothing to wait for
+
+    if( ready < 0 && flag.wait(timeout) )
+    {
+        for(uint_fast8_t i = 0; i < count && ready < 0; ++i)
+        {
+            if( futures[i]->is_ready() )
+                ready = i;
+        }
+    }
+
+    for(uint_fast8_t i = 0; i < count; ++i)
+    {
+        if( TFutureState* s = futures[i]->state() )
+            s->detach();
+    }
+    return ready;
+}
+
+} // ns OS
@@ -0,0 +1,316 @@
+/**
+  ******************************************************************************
+  * @file           : future.h
+  * @author         : ruixuezhao
+  * @brief          : Futures and promises for asynchronous completion
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef FUTURE_H
+#define FUTURE_H
+#include "vortexRT.h"
+#include <vortex/ext/mem-pool/mem_pool.h>
+#include <vortex/ext/work-queue/work_queue.h>
+#include <new>
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   TFutureState
+//
+//   Shared state of a promise/future pair, allocated from a future_pool.
+//   It is referenced by the promise, the future and a pending continuation,
+//   and returns to its pool when the last of them lets it go. The promise
+//   drops its reference as soon as it sets the value, so a driver may keep
+//   it in a static and complete it from the ISR.
+//
+//   Completion resumes processes blocked in get()/wait(), signals the
+//   listener of when_all()/when_any() and submits the continuation to its
+//   work queue.
+//
+class TFutureState : protected TService
+{
+public:
+    enum TStatus { fsEmpty, fsReady, fsBroken };
+
+    typedef void (*TFree)(TFutureState* self, bool isr);
+    typedef void (*TThunk)(TFutureState* self);
+
+    TFutureState(TFree f, void* pool);
+
+    bool wait(timeout_t timeout);               // false on timeout
+    void complete(TStatus status, bool isr);    // value must be stored before
+    void add_ref() { TCritSect cs; ++Refs; }
+    void release(bool isr = false);
+
+    bool attach(TEventFlag* listener);          // false if already completed
+    void detach() { TCritSect cs; Listener = 0; }
+    bool set_then(TWorkQueue& q, TThunk thunk, void (*fn)(), void* ctx);   // takes over the caller's reference
+
+    INLINE TStatus status() const { return static_cast<TStatus>(Status); }
+
+protected:
+    template<typename, uint16_t> friend class future_pool;
+
+    static void run_then(void* self);
+
+    void*                Pool;
+    void               (*ThenFn)();             // user continuation, cast back by Thunk
+    void*                ThenContext;
+    TFree                FreeFn;
+    volatile TProcessMap ProcessMap;
+    volatile uint8_t     Status;
+    volatile uint8_t     Refs;
+    TEventFlag*          Listener;
+    TWorkQueue*          Queue;
+    TThunk               Thunk;
+    TWork                Continuation;
+};
+
+template<typename T>
+class future_state : public TFutureState
+{
+public:
+    future_state(TFree f, void* pool) : TFutureState(f, pool) { }
+    ~future_state() { if(status() == fsReady) value()->~T(); }
+
+    INLINE T* value() { return reinterpret_cast<T*>(Storage); }
+
+    static void then_thunk(TFutureState* self)
+    {
+        future_state* s = static_cast<future_state*>(self);
+        reinterpret_cast<void (*)(const T*, void*)>(s->ThenFn)(s->status() == fsReady ? s->value() : 0, s->ThenContext);
+    }
+
+private:
+    alignas(T) unsigned char Storage[sizeof(T)];
+};
+
+//------------------------------------------------------------------------------
+//
+//   TFutureBase, future<T>
+//
+//   Move-only handle of the consumer side. get() may be called repeatedly
+//   once the value is set; it returns false on timeout and when the promise
+//   was destroyed without a value.
+//
+class TFutureBase
+{
+public:
+    INLINE bool valid()    const { return State != 0; }
+    INLINE bool is_ready() const { TCritSect cs; return State && State->status() != TFutureState::fsEmpty; }
+    INLINE bool wait(timeout_t timeout = 0) { return State && State->wait(timeout); }
+
+    INLINE TFutureState* state() const { return State; }
+
+protected:
+    INLINE TFutureBase(TFutureState* s = 0) : State(s) { }
+    INLINE ~TFutureBase() { if(State) State->release(); }
+
+    TFutureBase(const TFutureBase&) = delete;
+    TFutureBase& operator=(const TFutureBase&) = delete;
+
+    TFutureState* State;
+};
+
+template<typename T> class promise;
+
+template<typename T>
+class future : public TFutureBase
+{
+public:
+    INLINE future() { }
+    INLINE future(future&& other) : TFutureBase(other.State) { other.State = 0; }
+    INLINE future& operator=(future&& other)
+    {
+        if(this != &other)
+        {
+            if(State)
+                State->release();
+            State = other.State;
+            other.State = 0;
+        }
+        return *this;
+    }
+
+    bool get(T& value, timeout_t timeout = 0);
+
+    // runs fn(value, ctx) in the work queue's process once the value is set;
+    // value is 0 if the promise is broken. The future is consumed.
+    bool then(TWorkQueue& q, void (*fn)(const T* value, void* ctx), void* ctx = 0);
+
+private:
+    friend class promise<T>;
+    INLINE future(TFutureState* s) : TFutureBase(s) { }
+
+    INLINE future_state<T>* typed() const { return static_cast<future_state<T>*>(State); }
+};
+
+//------------------------------------------------------------------------------
+//
+//   promise<T>
+//
+//   Move-only handle of the producer side. get_future() may be called once.
+//   Destroying a promise that has not set the value breaks it.
+//
+template<typename T>
+class promise
+{
+public:
+    INLINE promise() : State(0), FutureTaken(false) { }
+    INLINE promise(promise&& other) : State(other.State), FutureTaken(other.FutureTaken) { other.State = 0; }
+    INLINE promise& operator=(promise&& other)
+    {
+        if(this != &other)
+        {
+            abandon();
+            State = other.State; FutureTaken = other.FutureTaken;
+            other.State = 0;
+        }
+        return *this;
+    }
+    INLINE ~promise() { abandon(); }
+
+    promise(const promise&) = delete;
+    promise& operator=(const promise&) = delete;
+
+    INLINE bool valid() const { return State != 0; }
+
+    future<T> get_future();
+
+    bool set_value    (const T& value) { return set(value, false); }
+    bool set_value_isr(const T& value) { return set(value, true);  }
+
+private:
+    template<typename, uint16_t> friend class future_pool;
+    INLINE promise(future_state<T>* s) : State(s), FutureTaken(false) { }
+
+    bool set(const T& value, bool isr);
+    void abandon();
+
+    future_state<T>* State;
+    bool             FutureTaken;
+};
+
+//------------------------------------------------------------------------------
+//
+//   future_pool<T, Count>
+//
+//   Count shared states for futures of T. make_promise() returns an
+//   invalid promise if the pool stays empty until timeout.
+//
+template<typename T, uint16_t Count>
+class future_pool
+{
+public:
+    INLINE promise<T> make_promise(timeout_t timeout = 0) { return promise<T>(init(Pool.alloc(timeout))); }
+    INLINE promise<T> make_promise_isr()                  { return promise<T>(init(Pool.try_alloc()));    }
+
+    INLINE const TMemPool<sizeof(future_state<T>), Count>& pool() const { return Pool; }      // statistics
+
+private:
+    INLINE future_state<T>* init(void* block) { return block ? new (block) future_state<T>(&free_state, this) : 0; }
+
+    static void free_state(TFutureState* self, bool isr)
+    {
+        future_pool* p = static_cast<future_pool*>(self->Pool);
+        static_cast<future_state<T>*>(self)->~future_state<T>();
+        if(isr)
+            p->Pool.free_isr(self);
+        else
+            p->Pool.free(self);
+    }
+
+    TMemPool<sizeof(future_state<T>), Count> Pool;
+};
+
+//------------------------------------------------------------------------------
+//
+//   Combinators
+//
+//   Block the caller until all (any) of the futures are ready. when_any()
+//   returns the index of a ready future or -1 on timeout. Invalid futures
+//   count as ready for when_all(); when_any() returns the first of them
+//   only if there is no valid future to wait for. A future can be watched
+//   by one combinator at a time.
+//
+bool         when_all(TFutureBase* const futures[], uint_fast8_t count, timeout_t timeout = 0);
+int_fast8_t  when_any(TFutureBase* const futures[], uint_fast8_t count, timeout_t timeout = 0);
+
+template<typename... F>
+INLINE bool when_all(timeout_t timeout, F&... f)
+{
+    TFutureBase* const list[] = { &f... };
+    return when_all(list, sizeof...(F), timeout);
+}
+
+template<typename... F>
+INLINE int_fast8_t when_any(timeout_t timeout, F&... f)
+{
+    TFutureBase* const list[] = { &f... };
+    return when_any(list, sizeof...(F), timeout);
+}
+
+} // ns OS
+//------------------------------------------------------------------------------
+template<typename T>
+bool OS::future<T>::get(T& value, timeout_t timeout)
+{
+    if( !State || !State->wait(timeout) || State->status() != TFutureState::fsReady )
+        return false;
+
+    value = *typed()->value();                  // immutable once ready
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T>
+bool OS::future<T>::then(TWorkQueue& q, void (*fn)(const T* value, void* ctx), void* ctx)
+{
+    if( !State )
+        return false;
+
+    TFutureState* s = State;
+    State = 0;
+    return s->set_then(q, &future_state<T>::then_thunk, reinterpret_cast<void (*)()>(fn), ctx);
+}
+//------------------------------------------------------------------------------
+template<typename T>
+OS::future<T> OS::promise<T>::get_future()
+{
+    if( !State || FutureTaken )
+        return future<T>();
+
+    FutureTaken = true;
+    State->add_ref();
+    return future<T>(State);
+}
+//------------------------------------------------------------------------------
+template<typename T>
+bool OS::promise<T>::set(const T& value, bool isr)
+{
+    if( !State )
+        return false;
+
+    // only the promise writes the value, readers wait for the status change
+    new (State->value()) T(value);
+    State->complete(TFutureState::fsReady, isr);
+    State->release(isr);
+    State = 0;
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T>
+void OS::promise<T>::abandon()
+{
+    if( !State )
+        return;
+
+    State->complete(TFutureState::fsBroken, false);
+    State->release();
+    State = 0;
+}
+//------------------------------------------------------------------------------
+
+#endif /* FUTURE_H */
@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : ipc_port.cpp
+  * @author         : ruixuezhao
+  * @brief          : Synchronous send/receive/reply rendezvous
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "ipc_port.h"
+
+namespace OS
+{
+
+bool TPort::send(const void* request, void* reply, timeout_t timeout)
+{
+    TCritSect cs;
+
+    const TProcessMap PrioTag = cur_proc_prio_tag();
+
+    Slots[cur_proc_priority()].Request = request;
+    Slots[cur_proc_priority()].Reply   = reply;
+    set_prio_tag(PendingMap, PrioTag);
+
+    // make the server ready without rescheduling: suspend() below
+    // performs the only context switch of this call
+    resume_next_ready_isr(ServersProcessMap);
+
+    cur_proc_timeout() = timeout;
+    for(;;)
+    {
+        suspend(ClientsProcessMap);
+        if( !is_timeouted(ClientsProcessMap) )
+        {
+            cur_proc_timeout() = 0;
+            return true;                          // released by reply()
+        }
+
+        if( PendingMap & PrioTag )                // request was not received yet
+        {
+            clr_prio_tag(PendingMap, PrioTag);
+            return false;
+        }
+
+        // server already owns the buffers, wait for reply
+        cur_proc_timeout() = 0;
+    }
+}
+
+
+
+const void* TPort::receive(TRcvId& id, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( !PendingMap )
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            suspend(ServersProcessMap);
+            if( is_timeouted(ServersProcessMap) )
+                return 0;                         // waked up by timeout or by externals
+        }
+        while( !PendingMap );                     // another server may have caught the request
+        cur_proc_timeout() = 0;
+    }
+
+    TProcessMap Tag = highest_prio_tag(PendingMap);
+    clr_prio_tag(PendingMap, Tag);
+    id = highest_priority(Tag);
+    return Slots[id].Request;
+}
+
+
+
+void TPort::reply(TRcvId id)
+{
+    TCritSect cs;
+
+    TProcessMap Tag = get_prio_tag(id);
+    if( !(ClientsProcessMap & Tag) || (PendingMap & Tag) )
+        return;                                   // not a received request
+
+    clr_prio_tag(ClientsProcessMap, Tag);
+    set_process_ready(id);
+    reschedule();
+}
+
+} // ns OS
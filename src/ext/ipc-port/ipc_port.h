@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file           : ipc_port.h
+  * @author         : ruixuezhao
+  * @brief          : Synchronous send/receive/reply rendezvous
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef IPC_PORT_H
+#define IPC_PORT_H
+#include "vortexRT.h"
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   TPort
+//
+//   Client calls send() and stays blocked until the server calls reply().
+//   Both sides are blocked while the transaction is in progress, so request
+//   and reply buffers are passed by pointer: the server reads the request
+//   in place and writes the reply straight into the client's buffer.
+//
+//   Ready map is updated without intermediate rescheduling, so every
+//   direction costs exactly one context switch: send() readies the server
+//   and suspends the client in one step, reply() readies the client and
+//   switches to it if it has higher priority.
+//
+//   Receive id is the client's priority; pending clients are served in
+//   priority order. Timeout of send() applies only until the request has
+//   been received - after that the server owns the buffers and the client
+//   waits for the reply.
+//
+typedef uint_fast8_t TRcvId;
+
+class TPort : protected TService
+{
+public:
+    TPort() : ClientsProcessMap(0), ServersProcessMap(0), PendingMap(0), Slots() { }
+
+    bool        send(const void* request, void* reply, timeout_t timeout = 0);
+    const void* receive(TRcvId& id, timeout_t timeout = 0);   // returns 0 on timeout
+    void*       reply_buffer(TRcvId id) const { return Slots[id].Reply; }
+    void        reply(TRcvId id);
+
+    bool has_pending() const { TCritSect cs; return PendingMap != 0; }
+
+protected:
+    struct TSlot
+    {
+        const void* Request;
+        void*       Reply;
+    };
+
+    volatile TProcessMap ClientsProcessMap;     // clients blocked in send()
+    volatile TProcessMap ServersProcessMap;     // servers blocked in receive()
+    volatile TProcessMap PendingMap;            // sent but not yet received requests
+    TSlot Slots[PROCESS_COUNT];                 // per-client buffers, indexed by priority
+};
+
+//------------------------------------------------------------------------------
+//
+//   Typed wrapper. Request is never copied, reply is copied once.
+//
+template<typename TRequest, typename TReply>
+class port : public TPort
+{
+public:
+    INLINE bool send(const TRequest& req, TReply& rep, timeout_t timeout = 0)
+    {
+        return TPort::send(&req, &rep, timeout);
+    }
+
+    INLINE const TRequest* receive(TRcvId& id, timeout_t timeout = 0)
+    {
+        return static_cast<const TRequest*>(TPort::receive(id, timeout));
+    }
+
+    INLINE TReply* reply_buffer(TRcvId id) const { return static_cast<TReply*>(TPort::reply_buffer(id)); }
+
+    INLINE void reply(TRcvId id)                 { TPort::reply(id); }
+    INLINE void reply(TRcvId id, const TReply& rep)
+    {
+        *reply_buffer(id) = rep;
+        TPort::reply(id);
+    }
+};
+
+} // ns OS
+
+#endif /* IPC_PORT_H */
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : mailbox.h
+  * @author         : ruixuezhao
+  * @brief          : Zero-copy mailbox of pooled message buffers
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef MAILBOX_H
+#define MAILBOX_H
+#include "vortexRT.h"
+#include <vortex/ext/mem-pool/mem_pool.h>
+#include <new>
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   mailbox
+//
+//   Messages live in a pool of Count buffers and only pointers travel
+//   through the queue, so posting costs the same for any sizeof(T).
+//   Ownership moves with the pointer:
+//
+//       producer:  T* m = mb.alloc();   fill *m in place;   mb.post(m);
+//       consumer:  T* m = mb.fetch();   process *m;         mb.release(m);
+//
+//   The queue holds all Count buffers, so post() never waits. alloc() waits
+//   for a free buffer, fetch() waits for a posted one. In debug builds a
+//   double or foreign release is rejected before the message is destroyed
+//   and counted by pool().get_bad_frees().
+//
+template<typename T, uint16_t Count>
+class mailbox
+{
+public:
+    T*   alloc      (timeout_t timeout = 0)  { return construct(Pool.alloc(timeout)); }   // 0 on timeout
+    T*   alloc_isr  ()                       { return construct(Pool.try_alloc());    }   // 0 if no free buffer
+
+    INLINE void post    (T* msg)             { Queue.push(msg);            }
+    INLINE bool post_isr(T* msg)             { return Queue.push_isr(msg); }
+
+    T*   fetch      (timeout_t timeout = 0)  { T* msg; return Queue.pop(msg, timeout) ? msg : 0; }   // 0 on timeout
+
+    // false if the release was rejected (debug builds only)
+    bool release    (T* msg)                 { const bool ok = destroy(msg); Pool.free(msg);     return ok; }
+    bool release_isr(T* msg)                 { const bool ok = destroy(msg); Pool.free_isr(msg); return ok; }
+
+    INLINE uint16_t get_count() const        { return Queue.get_count(); }                    // posted messages
+    INLINE const TMemPool<sizeof(T), Count>& pool() const { return Pool; }                    // statistics
+
+protected:
+    static T* construct(void* block) { return block ? new (block) T() : 0; }
+
+    // destroys the message unless the pool is going to reject its release
+    bool destroy(T* msg)
+    {
+#if vortexRT_DEBUG_ENABLE == 1
+        if(!Pool.is_allocated(msg))
+            return false;
+#endif
+        msg->~T();
+        return true;
+    }
+
+    TMemPool<sizeof(T), Count> Pool;
+    channel<T*, Count, uint16_t> Queue;
+};
+
+} // ns OS
+
+#endif /* MAILBOX_H */
@@ -0,0 +1,278 @@
+/**
+  ******************************************************************************
+  * @file           : mem_pool.h
+  * @author         : ruixuezhao
+  * @brief          : Fixed-block memory pool
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+#include "vortexRT.h"
+#include <atomic>
+#include <cstddef>
+
+//------------------------------------------------------------------------------
+//
+//   Free list access method
+//
+//   1 - lock-free: the list head is updated by compare-and-swap (LDREX/STREX
+//       on ARMv7-M), interrupts stay enabled in alloc/free.
+//   0 - the list is updated inside a critical section. ARMv6-M has no
+//       exclusive access instructions, so it always uses this method.
+//
+#ifndef vortexRT_MEMPOOL_LOCK_FREE
+#if (defined __ARM_ARCH_6M__)
+#define vortexRT_MEMPOOL_LOCK_FREE  0
+#else
+#define vortexRT_MEMPOOL_LOCK_FREE  1
+#endif
+#endif
+
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   TMemPool
+//
+//   Count blocks of BlockSize bytes with O(1) alloc and free. Free blocks are
+//   linked by index through their own first bytes, so the pool has no
+//   per-block overhead. Blocks are aligned for any fundamental type.
+//
+//   The list head keeps a 16-bit modification tag next to the 16-bit index
+//   of the first free block, which prevents ABA when a process is preempted
+//   in the middle of a lock-free update.
+//
+//   alloc(timeout) suspends the caller while the pool is empty; free() and
+//   free_isr() resume the highest priority waiter. try_alloc() never waits
+//   and is ISR-safe.
+//
+//   With vortexRT_DEBUG_ENABLE the pool keeps a bitmap of allocated blocks:
+//   freeing a block that is not allocated (double free or foreign pointer)
+//   is rejected and counted by get_bad_frees(), is_allocated() helps to find
+//   leaked blocks.
+//
+template<uint16_t BlockSize, uint16_t Count>
+class TMemPool : protected TService
+{
+    static_assert(Count >= 1 && Count < 0xFFFF, "TMemPool block count must be in range 1..0xFFFE");
+
+public:
+    enum
+    {
+        ALIGN      = alignof(std::max_align_t),
+        BLOCK_SIZE = ((BlockSize < sizeof(uint16_t) ? sizeof(uint16_t) : BlockSize) + ALIGN - 1) / ALIGN * ALIGN,
+        NIL        = 0xFFFF
+    };
+
+    TMemPool()
+        : ProcessMap(0)
+        , Head(0)
+        , Used(0)
+        , HighWater(0)
+#if vortexRT_DEBUG_ENABLE == 1
+        , BadFrees(0)
+        , Allocated()
+#endif
+    {
+        for(uint16_t i = 0; i < Count; ++i)
+            next(i) = i + 1 < Count ? i + 1 : NIL;
+    }
+
+    void* alloc(timeout_t timeout = 0);                 // returns 0 on timeout
+    void* try_alloc();                                  // returns 0 if pool is empty
+    void  free(void* block);
+    void  free_isr(void* block);
+
+    bool  owns(const void* p) const
+    {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        return b >= Pool[0] && b < Pool[0] + sizeof(Pool) && (b - Pool[0]) % BLOCK_SIZE == 0;
+    }
+
+    // statistics
+    INLINE uint16_t get_used()       const { return Used.load(std::memory_order_relaxed); }
+    INLINE uint16_t get_free_count() const { return Count - get_used(); }
+    INLINE uint16_t get_high_water() const { return HighWater.load(std::memory_order_relaxed); }
+    INLINE void     reset_high_water()     { TCritSect cs; HighWater.store(Used.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+#if vortexRT_DEBUG_ENABLE == 1
+    INLINE uint16_t get_bad_frees()  const { return BadFrees; }
+    INLINE bool     is_allocated(const void* p) const
+    {
+        TCritSect cs;
+        if(!owns(p))
+            return false;
+        const uint16_t i = index(p);
+        return Allocated[i / 32] & (1ul << (i % 32));
+    }
+#endif
+
+protected:
+    uint16_t& next(uint16_t i)         { return *reinterpret_cast<uint16_t*>(Pool[i]); }
+    uint16_t  index(const void* block) const
+    {
+        return static_cast<uint16_t>((static_cast<const uint8_t*>(block) - Pool[0]) / BLOCK_SIZE);
+    }
+    bool      push(void* block);                        // returns block to the free list
+#if vortexRT_DEBUG_ENABLE == 1
+    void      track_alloc(uint16_t i) { TCritSect cs; Allocated[i / 32] |= 1ul << (i % 32); }
+    bool      track_free(const void* block);
+#endif
+
+    volatile TProcessMap  ProcessMap;                   // processes waiting for a free block
+    std::atomic<uint32_t> Head;                         // tag << 16 | index of the first free block
+    std::atomic<uint16_t> Used;
+    std::atomic<uint16_t> HighWater;
+#if vortexRT_DEBUG_ENABLE == 1
+    volatile uint16_t     BadFrees;
+    uint32_t              Allocated[(Count + 31) / 32];
+#endif
+    alignas(ALIGN) uint8_t Pool[Count][BLOCK_SIZE];
+};
+
+//------------------------------------------------------------------------------
+//
+//       TMemPool function-members implementation
+//
+//------------------------------------------------------------------------------
+template<uint16_t BlockSize, uint16_t Count>
+void* TMemPool<BlockSize, Count>::try_alloc()
+{
+#if vortexRT_MEMPOOL_LOCK_FREE == 1
+    uint32_t h = Head.load(std::memory_order_acquire);
+    uint16_t i;
+    do
+    {
+        i = h & 0xFFFF;
+        if(i == NIL)
+            return 0;
+        // the block may be taken by a preempting process at this point - then
+        // 'next' is stale, but the tag has changed and the CAS fails
+    }
+    while( !Head.compare_exchange_weak(h, ((h + 0x10000) & 0xFFFF0000) | next(i),
+                                        std::memory_order_acquire, std::memory_order_acquire) );
+
+    const uint16_t used = Used.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint16_t hw = HighWater.load(std::memory_order_relaxed);
+    while(used > hw && !HighWater.compare_exchange_weak(hw, used, std::memory_order_relaxed)) { }
+#else
+    TCritSect cs;
+
+    const uint32_t h = Head.load(std::memory_order_relaxed);
+    const uint16_t i = h & 0xFFFF;
+    if(i == NIL)
+        return 0;
+    Head.store(((h + 0x10000) & 0xFFFF0000) | next(i), std::memory_order_relaxed);
+
+    const uint16_t used = Used.load(std::memory_order_relaxed) + 1;
+    Used.store(used, std::memory_order_relaxed);
+    if(used > HighWater.load(std::memory_order_relaxed))
+        HighWater.store(used, std::memory_order_relaxed);
+#endif
+
+#if vortexRT_DEBUG_ENABLE == 1
+    track_alloc(i);
+#endif
+    return Pool[i];
+}
+//------------------------------------------------------------------------------
+#if vortexRT_DEBUG_ENABLE == 1
+template<uint16_t BlockSize, uint16_t Count>
+bool TMemPool<BlockSize, Count>::track_free(const void* block)
+{
+    TCritSect cs;
+
+    if(owns(block))
+    {
+        const uint16_t i    = index(block);
+        const uint32_t mask = 1ul << (i % 32);
+        if(Allocated[i / 32] & mask)
+        {
+            Allocated[i / 32] &= ~mask;
+            return true;
+        }
+    }
+    BadFrees = BadFrees + 1;
+    return false;
+}
+#endif
+//------------------------------------------------------------------------------
+template<uint16_t BlockSize, uint16_t Count>
+bool TMemPool<BlockSize, Count>::push(void* block)
+{
+#if vortexRT_DEBUG_ENABLE == 1
+    if(!track_free(block))
+        return false;                               // keep the free list intact
+#endif
+
+    const uint16_t i = index(block);
+#if vortexRT_MEMPOOL_LOCK_FREE == 1
+    Used.fetch_sub(1, std::memory_order_relaxed);
+    uint32_t h = Head.load(std::memory_order_relaxed);
+    do
+    {
+        next(i) = h & 0xFFFF;
+    }
+    while( !Head.compare_exchange_weak(h, ((h + 0x10000) & 0xFFFF0000) | i,
+                                        std::memory_order_release, std::memory_order_relaxed) );
+#else
+    TCritSect cs;
+
+    Used.store(Used.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    const uint32_t h = Head.load(std::memory_order_relaxed);
+    next(i) = h & 0xFFFF;
+    Head.store(((h + 0x10000) & 0xFFFF0000) | i, std::memory_order_relaxed);
+#endif
+    return true;
+}
+//------------------------------------------------------------------------------
+template<uint16_t BlockSize, uint16_t Count>
+void* TMemPool<BlockSize, Count>::alloc(timeout_t timeout)
+{
+    void* block = try_alloc();
+    if(block)
+        return block;
+
+    TCritSect cs;
+
+    // free() can't run between the check and suspend() - it would find
+    // the process in ProcessMap and resume it
+    cur_proc_timeout() = timeout;
+    while( !(block = try_alloc()) )
+    {
+        // pool is empty, suspend current process until a block is freed or timeout
+        suspend(ProcessMap);
+        if(is_timeouted(ProcessMap))
+            return 0;
+    }
+    cur_proc_timeout() = 0;
+    return block;
+}
+//------------------------------------------------------------------------------
+template<uint16_t BlockSize, uint16_t Count>
+void TMemPool<BlockSize, Count>::free(void* block)
+{
+    if(push(block) && ProcessMap)
+    {
+        TCritSect cs;
+        resume_next_ready(ProcessMap);
+    }
+}
+//------------------------------------------------------------------------------
+template<uint16_t BlockSize, uint16_t Count>
+void TMemPool<BlockSize, Count>::free_isr(void* block)
+{
+    if(push(block) && ProcessMap)
+    {
+        TCritSect cs;
+        resume_next_ready_isr(ProcessMap);
+    }
+}
+//------------------------------------------------------------------------------
+
+} // ns OS
+
+#endif /* MEM_POOL_H */
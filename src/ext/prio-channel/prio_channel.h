@@ -0,0 +1,259 @@
+/**
+  ******************************************************************************
+  * @file           : prio_channel.h
+  * @author         : ruixuezhao
+  * @brief          : Priority-ordered message queue
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef PRIO_CHANNEL_H
+#define PRIO_CHANNEL_H
+#include "vortexRT.h"
+#include <new>
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   prio_channel
+//
+//   Queue that delivers items in priority order: pop() returns the item with
+//   the highest priority value, items of equal priority come out in FIFO
+//   order. Waiting and timeouts work like in channel<T>.
+//
+//   Items stay in their storage slots, the binary heap orders only small
+//   (priority, sequence, slot) entries, so push and pop cost O(log Size)
+//   entry swaps inside the critical section regardless of sizeof(T).
+//
+template<typename T, uint16_t Size, typename S = uint8_t, typename P = uint8_t>
+class prio_channel : protected TService
+{
+    static_assert(Size >= 1 && Size <= static_cast<S>(~S(0)), "prio_channel size doesn't fit count type");
+
+public:
+    INLINE prio_channel()
+        : ProducersProcessMap(0)
+        , ConsumersProcessMap(0)
+        , Count(0)
+        , Seq(0)
+    {
+        for(uint16_t i = 0; i < Size; ++i)
+            FreeSlots[i] = static_cast<S>(i);
+    }
+    ~prio_channel() { flush_items(); }
+
+    prio_channel(const prio_channel&) = delete;
+    prio_channel& operator=(const prio_channel&) = delete;
+
+    void push    (const T& item, P prio);
+    void push    (T&& item, P prio);
+    bool push_isr(const T& item, P prio);       // false if the channel is full
+
+    // item is move-assigned from the channel
+    bool pop     (T& item, timeout_t timeout = 0);
+    bool pop     (T& item, P& prio, timeout_t timeout = 0);
+
+    INLINE S    get_count()     const { TCritSect cs; return Count; }
+    INLINE S    get_free_size() const { TCritSect cs; return Size - Count; }
+           void flush();
+
+protected:
+    struct TEntry
+    {
+        P        Prio;
+        S        Slot;
+        uint32_t Seq;                           // arrival order among equal priorities
+    };
+
+    // a goes before b
+    static bool before(const TEntry& a, const TEntry& b)
+    {
+        return a.Prio != b.Prio ? a.Prio > b.Prio : static_cast<int32_t>(a.Seq - b.Seq) < 0;
+    }
+
+    T*   slot(const S i) { return reinterpret_cast<T*>(Buf) + i; }
+    void wait_room();
+    S    alloc_slot(P prio);                    // takes a free slot and makes its heap entry
+    void sift_up(S i);
+    void sift_down(S i);
+    void take(T& item, P& prio);
+    void flush_items();
+
+    volatile TProcessMap ProducersProcessMap;
+    volatile TProcessMap ConsumersProcessMap;
+
+    S        Count;
+    uint32_t Seq;
+    TEntry   Heap[Size];
+    S        FreeSlots[Size];                   // stack of unused slots, Size - Count entries
+    alignas(T) uint8_t Buf[Size * sizeof(T)];
+};
+
+//------------------------------------------------------------------------------
+//
+//       prio_channel function-members implementation
+//
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::wait_room()
+{
+    while(Count == Size)
+    {
+        // channel is full, suspend current process until item removed
+        suspend(ProducersProcessMap);
+    }
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+S prio_channel<T, Size, S, P>::alloc_slot(P prio)
+{
+    const S s = FreeSlots[Size - 1 - Count];
+    Heap[Count].Prio = prio;
+    Heap[Count].Slot = s;
+    Heap[Count].Seq  = Seq++;
+    return s;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::sift_up(S i)
+{
+    const TEntry e = Heap[i];
+    while(i)
+    {
+        const S parent = (i - 1) / 2;
+        if( !before(e, Heap[parent]) )
+            break;
+        Heap[i] = Heap[parent];
+        i = parent;
+    }
+    Heap[i] = e;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::sift_down(S i)
+{
+    const TEntry e = Heap[i];
+    for(;;)
+    {
+        uint32_t child = 2u * i + 1;               // doesn't wrap for Size above 32768
+        if(child >= Count)
+            break;
+        if(child + 1u < Count && before(Heap[child + 1], Heap[child]))
+            ++child;
+        if( !before(Heap[child], e) )
+            break;
+        Heap[i] = Heap[child];
+        i = static_cast<S>(child);
+    }
+    Heap[i] = e;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::push(const T& item, P prio)
+{
+    TCritSect cs;
+
+    wait_room();
+    new (slot(alloc_slot(prio))) T(item);
+    sift_up(Count++);
+    resume_all(ConsumersProcessMap);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::push(T&& item, P prio)
+{
+    TCritSect cs;
+
+    wait_room();
+    new (slot(alloc_slot(prio))) T(static_cast<T&&>(item));
+    sift_up(Count++);
+    resume_all(ConsumersProcessMap);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+bool prio_channel<T, Size, S, P>::push_isr(const T& item, P prio)
+{
+    TCritSect cs;
+
+    if(Count == Size)
+        return false;
+
+    new (slot(alloc_slot(prio))) T(item);
+    sift_up(Count++);
+    resume_all_isr(ConsumersProcessMap);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::take(T& item, P& prio)
+{
+    const S s = Heap[0].Slot;
+    prio = Heap[0].Prio;
+    item = static_cast<T&&>(*slot(s));
+    slot(s)->~T();
+
+    FreeSlots[Size - Count] = s;
+    if(--Count)
+    {
+        Heap[0] = Heap[Count];
+        sift_down(0);
+    }
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+bool prio_channel<T, Size, S, P>::pop(T& item, P& prio, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if(!Count)
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // channel is empty, suspend current process until item received or timeout
+            suspend(ConsumersProcessMap);
+            if(is_timeouted(ConsumersProcessMap))
+                return false;
+        }
+        while(!Count);
+        cur_proc_timeout() = 0;
+    }
+
+    take(item, prio);
+    resume_all(ProducersProcessMap);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+bool prio_channel<T, Size, S, P>::pop(T& item, timeout_t timeout)
+{
+    P prio;
+    return pop(item, prio, timeout);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::flush_items()
+{
+    while(Count)
+    {
+        --Count;
+        const S s = Heap[Count].Slot;
+        slot(s)->~T();
+        FreeSlots[Size - 1 - Count] = s;
+    }
+}
+//------------------------------------------------------------------------------
+template<typename T, uint16_t Size, typename S, typename P>
+void prio_channel<T, Size, S, P>::flush()
+{
+    TCritSect cs;
+
+    flush_items();
+    resume_all(ProducersProcessMap);
+}
+//------------------------------------------------------------------------------
+
+} // ns OS
+
+#endif /* PRIO_CHANNEL_H */
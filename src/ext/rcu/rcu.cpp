@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : rcu.cpp
+  * @author         : ruixuezhao
+  * @brief          : Read-copy-update for read-mostly shared data
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "rcu.h"
+
+namespace OS
+{
+
+bool TRcu::synchronize(timeout_t timeout)
+{
+    TCritSect cs;
+
+    // wait for processes that are inside a read section right now; readers
+    // that enter later already see the new pointer
+    const uint_fast8_t self = cur_proc_priority();
+    TProcessMap Readers = 0;
+    for(uint_fast8_t prio = 0; prio < PROCESS_COUNT; ++prio)
+    {
+        if(Nesting[prio] && prio != self)
+            set_prio_tag(Readers, get_prio_tag(prio));
+    }
+    if( !Readers )
+        return true;
+
+    GracePending |= Readers;                      // other writers may wait too
+    cur_proc_timeout() = timeout;
+    do
+    {
+        suspend(WritersProcessMap);
+        if( is_timeouted(WritersProcessMap) )
+            return false;
+    }
+    while( GracePending & Readers );
+    cur_proc_timeout() = 0;
+    return true;
+}
+
+
+
+void TRcu::end_grace(uint_fast8_t prio)
+{
+    TCritSect cs;
+
+    clr_prio_tag(GracePending, get_prio_tag(prio));
+    resume_all(WritersProcessMap);
+}
+
+} // ns OS
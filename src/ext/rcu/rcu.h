@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file           : rcu.h
+  * @author         : ruixuezhao
+  * @brief          : Read-copy-update for read-mostly shared data
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef RCU_H
+#define RCU_H
+#include "vortexRT.h"
+#include <atomic>
+
+//------------------------------------------------------------------------------
+//
+//   Pointer exchange method
+//
+//   1 - lock-free: rcu_ptr::exchange() is an atomic exchange.
+//   0 - the pointer is exchanged inside a critical section. ARMv6-M has no
+//       exclusive access instructions, so it always uses this method.
+//
+#ifndef vortexRT_RCU_LOCK_FREE
+#if (defined __ARM_ARCH_6M__)
+#define vortexRT_RCU_LOCK_FREE  0
+#else
+#define vortexRT_RCU_LOCK_FREE  1
+#endif
+#endif
+
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   TRcu
+//
+//   Readers access shared data through rcu_ptr inside read_lock() /
+//   read_unlock(). The read side neither blocks nor masks interrupts: it
+//   only changes a nesting counter owned by the current process.
+//
+//   A writer publishes a new copy with rcu_ptr::exchange() and calls
+//   synchronize() before it reclaims the old copy. synchronize() waits until
+//   every process that was inside a read section at that moment has left it
+//   - the last read_unlock() of such a process resumes the writer. Processes
+//   are preemptive, so a context switch is not a quiescent point here; the
+//   end of the read section is.
+//
+//   ISRs can't be preempted by processes, so an ISR reader needs no read
+//   section. A process must not call synchronize() inside its own read
+//   section.
+//
+class TRcu : protected TService
+{
+public:
+    TRcu() : WritersProcessMap(0), GracePending(0), Nesting() { }
+
+    INLINE void read_lock()
+    {
+        ++Nesting[cur_proc_priority()];
+        std::atomic_signal_fence(std::memory_order_seq_cst);    // section reads stay after the increment
+    }
+
+    INLINE void read_unlock()
+    {
+        std::atomic_signal_fence(std::memory_order_seq_cst);    // section reads stay before the decrement
+        const uint_fast8_t prio = cur_proc_priority();
+        if( !--Nesting[prio] && (GracePending & get_prio_tag(prio)) )
+            end_grace(prio);
+    }
+
+    bool synchronize(timeout_t timeout = 0);    // false on timeout - old data is still in use
+
+protected:
+    void end_grace(uint_fast8_t prio);
+
+    volatile TProcessMap WritersProcessMap;     // writers waiting in synchronize()
+    volatile TProcessMap GracePending;          // readers synchronize() waits for
+    volatile uint8_t     Nesting[PROCESS_COUNT];// read section depth of each process
+};
+
+//------------------------------------------------------------------------------
+//
+//   Pointer to RCU-protected data
+//
+template<typename T>
+class rcu_ptr
+{
+public:
+    rcu_ptr(T* p = 0) : Ptr(p) { }
+
+    // reader: call inside a read section, the data stays valid until read_unlock()
+    INLINE const T* read() const        { return Ptr.load(std::memory_order_acquire); }
+
+    // writer: publishes new data, returns the old one to be reclaimed after synchronize()
+    INLINE T* exchange(T* p)
+    {
+    #if vortexRT_RCU_LOCK_FREE == 1
+        return Ptr.exchange(p, std::memory_order_acq_rel);
+    #else
+        TCritSect cs;
+        T* old = Ptr.load(std::memory_order_relaxed);
+        Ptr.store(p, std::memory_order_release);
+        return old;
+    #endif
+    }
+
+private:
+    std::atomic<T*> Ptr;
+};
+
+//------------------------------------------------------------------------------
+class TRcuReadLock
+{
+public:
+    TRcuReadLock(TRcu& r) : rcu(r) { rcu.read_lock(); }
+    ~TRcuReadLock() { rcu.read_unlock(); }
+private:
+    TRcu& rcu;
+};
+
+} // ns OS
+
+#endif /* RCU_H */
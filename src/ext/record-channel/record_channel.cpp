@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @file           : record_channel.cpp
+  * @author         : ruixuezhao
+  * @brief          : Variable-length record queue over a byte ring
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "record_channel.h"
+
+namespace OS
+{
+
+bool TRecordChannel::put(const void* data, uint16_t len)
+{
+    if( !Used )
+    {
+        Head = 0;                                 // empty: restart from the buffer start
+        Tail = 0;                                 // to get the longest contiguous room
+    }
+
+    const uint16_t need = HDR_SIZE + len;
+    const uint16_t end  = Size - Tail;
+    const uint16_t free = Size - Used;
+
+    if( end >= need )
+    {
+        if( free < need )
+            return false;
+    }
+    else
+    {
+        if( free < end + need )                   // the tail is wasted as padding
+            return false;
+
+        if( end >= HDR_SIZE )
+        {
+            const uint16_t pad = PAD;
+            memcpy(Buf + Tail, &pad, HDR_SIZE);
+        }
+        Used += end;
+        Tail  = 0;
+    }
+
+    memcpy(Buf + Tail, &len, HDR_SIZE);
+    memcpy(Buf + Tail + HDR_SIZE, data, len);
+    Tail += need;
+    if( Tail == Size )
+        Tail = 0;
+    Used += need;
+    ++Count;
+    return true;
+}
+
+
+
+uint16_t TRecordChannel::front()
+{
+    const uint16_t end = Size - Head;
+    if( end < HDR_SIZE || hdr(Head) == PAD )
+    {
+        Used -= end;
+        Head  = 0;
+    }
+    return hdr(Head);
+}
+
+
+
+void TRecordChannel::drop(uint16_t len)
+{
+    const uint16_t n = HDR_SIZE + len;
+    Head += n;
+    if( Head == Size )
+        Head = 0;
+    Used -= n;
+    --Count;
+}
+
+
+
+bool TRecordChannel::wait_record(timeout_t timeout)
+{
+    if( Count )
+        return true;
+
+    cur_proc_timeout() = timeout;
+    do
+    {
+        // channel is empty, suspend current process until record received or timeout
+        suspend(ConsumersProcessMap);
+        if( is_timeouted(ConsumersProcessMap) )
+            return false;
+    }
+    while( !Count );
+    cur_proc_timeout() = 0;
+    return true;
+}
+
+
+
+bool TRecordChannel::write_record(const void* data, uint16_t len, timeout_t timeout)
+{
+    if( !len || len > Size - HDR_SIZE )
+        return false;                             // would never fit
+
+    TCritSect cs;
+
+    if( !put(data, len) )
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // not enough room, suspend current process until records removed or timeout
+            suspend(ProducersProcessMap);
+            if( is_timeouted(ProducersProcessMap) )
+                return false;
+        }
+        while( !put(data, len) );
+        cur_proc_timeout() = 0;
+    }
+
+    resume_all(ConsumersProcessMap);
+    return true;
+}
+
+
+
+bool TRecordChannel::write_record_isr(const void* data, uint16_t len)
+{
+    if( !len || len > Size - HDR_SIZE )
+        return false;
+
+    TCritSect cs;
+
+    if( !put(data, len) )
+        return false;
+
+    resume_all_isr(ConsumersProcessMap);
+    return true;
+}
+
+
+
+uint16_t TRecordChannel::read_record(void* buf, uint16_t maxlen, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( !wait_record(timeout) )
+        return 0;
+
+    const uint16_t len = front();
+    memcpy(buf, Buf + Head + HDR_SIZE, len < maxlen ? len : maxlen);
+    drop(len);
+    resume_all(ProducersProcessMap);
+    return len;
+}
+
+
+
+const uint8_t* TRecordChannel::peek(uint16_t& len, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if( !wait_record(timeout) )
+    {
+        len = 0;
+        return 0;
+    }
+
+    len = front();
+    return Buf + Head + HDR_SIZE;
+}
+
+
+
+void TRecordChannel::consume()
+{
+    TCritSect cs;
+
+    if( !Count )
+        return;
+
+    drop(front());
+    resume_all(ProducersProcessMap);
+}
+
+
+
+void TRecordChannel::consume_isr()
+{
+    TCritSect cs;
+
+    if( !Count )
+        return;
+
+    drop(front());
+    resume_all_isr(ProducersProcessMap);
+}
+
+
+
+void TRecordChannel::flush()
+{
+    TCritSect cs;
+
+    Head  = 0;
+    Tail  = 0;
+    Used  = 0;
+    Count = 0;
+    resume_all(ProducersProcessMap);
+}
+
+} // ns OS
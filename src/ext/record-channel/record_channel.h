@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file           : record_channel.h
+  * @author         : ruixuezhao
+  * @brief          : Variable-length record queue over a byte ring
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef RECORD_CHANNEL_H
+#define RECORD_CHANNEL_H
+#include "vortexRT.h"
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   TRecordChannel
+//
+//   Queue of variable-length records stored in a user-supplied byte buffer.
+//   Each record takes a 2-byte length header plus its payload, so memory
+//   scales with the actual payload size rather than with the largest message.
+//
+//   Records are always contiguous: if a record doesn't fit before the buffer
+//   end, the tail is marked as padding (PAD header, or nothing if less than
+//   a header is left) and the record is placed at the buffer start. That lets
+//   peek() return the payload in place; consume() releases it afterwards.
+//   Payload is byte-aligned - copy it out before accessing multi-byte fields.
+//
+//   Record length must be in range 1..size-2; empty records are not allowed,
+//   so read_record() returns 0 only on timeout. Only one consumer may use
+//   peek()/consume() at a time.
+//
+class TRecordChannel : protected TService
+{
+public:
+    TRecordChannel(uint8_t* buf, uint16_t size)
+        : ProducersProcessMap(0)
+        , ConsumersProcessMap(0)
+        , Buf(buf)
+        , Size(size)
+        , Head(0)
+        , Tail(0)
+        , Used(0)
+        , Count(0)
+    {
+    }
+
+    bool     write_record    (const void* data, uint16_t len, timeout_t timeout = 0);   // false on timeout or bad length
+    bool     write_record_isr(const void* data, uint16_t len);                          // false if no room
+
+    // copies at most maxlen bytes, the rest of a longer record is discarded;
+    // returns the full record length, 0 on timeout
+    uint16_t read_record     (void* buf, uint16_t maxlen, timeout_t timeout = 0);
+
+    const uint8_t* peek      (uint16_t& len, timeout_t timeout = 0);                    // returns 0 on timeout
+    void           consume   ();
+    void           consume_isr();
+
+    INLINE uint16_t get_count()     const { TCritSect cs; return Count; }
+    INLINE uint16_t get_free_size() const { TCritSect cs; return Size - Used; }
+           void     flush();
+
+protected:
+    enum
+    {
+        HDR_SIZE = sizeof(uint16_t),
+        PAD      = 0xFFFF
+    };
+
+    bool     put(const void* data, uint16_t len);
+    bool     wait_record(timeout_t timeout);
+    uint16_t front();                           // skips padding, returns front record length
+    void     drop(uint16_t len);
+    uint16_t hdr(uint16_t pos) const { uint16_t x; memcpy(&x, Buf + pos, HDR_SIZE); return x; }
+
+    volatile TProcessMap ProducersProcessMap;
+    volatile TProcessMap ConsumersProcessMap;
+
+    uint8_t* const Buf;
+    const uint16_t Size;
+    uint16_t       Head;                        // read position
+    uint16_t       Tail;                        // write position
+    uint16_t       Used;                        // occupied bytes including headers and padding
+    uint16_t       Count;                       // records
+};
+
+} // ns OS
+
+#endif /* RECORD_CHANNEL_H */
@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file           : rw_lock.cpp
+  * @author         : ruixuezhao
+  * @brief          : Reader-writer lock
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "rw_lock.h"
+
+namespace OS
+{
+
+void TRWLock::lock_shared()
+{
+    TCritSect cs;
+
+    while ( WriterTag || WritersProcessMap )
+        suspend(ReadersProcessMap);
+    set_prio_tag(ReadersTag, cur_proc_prio_tag());
+}
+
+
+
+bool TRWLock::try_lock_shared(timeout_t timeout)
+{
+    TCritSect cs;
+
+    while ( WriterTag || WritersProcessMap )
+    {
+        cur_proc_timeout() = timeout;
+        suspend(ReadersProcessMap);
+        if ( is_timeouted(ReadersProcessMap) )
+            return false;                 // waked up by timeout or by externals
+        cur_proc_timeout() = 0;
+    }
+    set_prio_tag(ReadersTag, cur_proc_prio_tag());
+    return true;
+}
+
+
+
+void TRWLock::unlock_shared()
+{
+    TCritSect cs;
+
+    TProcessMap Tag = cur_proc_prio_tag();
+    if ( !(ReadersTag & Tag) )
+        return;
+    clr_prio_tag(ReadersTag, Tag);
+    if ( !ReadersTag )
+        resume_next_ready(WritersProcessMap);
+}
+
+
+
+void TRWLock::lock()
+{
+    TCritSect cs;
+
+    while ( WriterTag || ReadersTag )
+        suspend(WritersProcessMap);
+    WriterTag = cur_proc_prio_tag();
+}
+
+
+
+bool TRWLock::try_lock(timeout_t timeout)
+{
+    TCritSect cs;
+
+    while ( WriterTag || ReadersTag )
+    {
+        cur_proc_timeout() = timeout;
+        suspend(WritersProcessMap);
+        if ( is_timeouted(WritersProcessMap) )
+        {
+            // readers held back by this writer may proceed now
+            if ( !WriterTag && !WritersProcessMap )
+                resume_all(ReadersProcessMap);
+            return false;
+        }
+        cur_proc_timeout() = 0;
+    }
+    WriterTag = cur_proc_prio_tag();
+    return true;
+}
+
+
+
+void TRWLock::unlock()
+{
+    TCritSect cs;
+
+    if ( WriterTag != cur_proc_prio_tag() )
+        return;
+    WriterTag = 0;
+    if ( !resume_next_ready(WritersProcessMap) )
+        resume_all(ReadersProcessMap);
+}
+
+} // ns OS
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : rw_lock.h
+  * @author         : ruixuezhao
+  * @brief          : Reader-writer lock
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef RW_LOCK_H
+#define RW_LOCK_H
+#include "vortexRT.h"
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   Any number of processes may hold the lock in shared mode, one process
+//   may hold it in exclusive mode. Waiting writers have preference: new
+//   readers are held back while a writer waits, so writers can't starve.
+//
+//   Owners are kept as prio tags, so the lock is not recursive in either
+//   mode and only the owner can release it.
+//
+class TRWLock : protected TService
+{
+public:
+    TRWLock() : ReadersProcessMap(0), WritersProcessMap(0), ReadersTag(0), WriterTag(0) { }
+
+    void lock_shared();
+    bool try_lock_shared(timeout_t timeout);
+    bool try_lock_shared()   { TCritSect cs; if(WriterTag || WritersProcessMap) return false; else lock_shared(); return true; }
+    void unlock_shared();
+
+    void lock();
+    bool try_lock(timeout_t timeout);
+    bool try_lock()          { TCritSect cs; if(WriterTag || ReadersTag) return false; else lock(); return true; }
+    void unlock();
+
+    bool is_locked() const   { TCritSect cs; return WriterTag != 0; }
+    bool is_shared() const   { TCritSect cs; return ReadersTag != 0; }
+
+protected:
+    volatile TProcessMap ReadersProcessMap;     // processes waiting for shared access
+    volatile TProcessMap WritersProcessMap;     // processes waiting for exclusive access
+    volatile TProcessMap ReadersTag;            // current shared owners
+    volatile TProcessMap WriterTag;             // current exclusive owner
+};
+
+//------------------------------------------------------------------------------
+template <typename Lock>
+class TSharedLock
+{
+public:
+    TSharedLock(Lock& l): lk(l) { lk.lock_shared(); }
+    ~TSharedLock() { lk.unlock_shared(); }
+private:
+    Lock & lk;
+};
+
+typedef TSharedLock<OS::TRWLock>  TRWLockReader;
+typedef TScopedLock<OS::TRWLock>  TRWLockWriter;
+
+} // ns OS
+
+#endif /* RW_LOCK_H */
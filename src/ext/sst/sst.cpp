@@ -0,0 +1,53 @@
+/**
+  ******************************************************************************
+  * @file           : sst.cpp
+  * @author         : ruixuezhao
+  * @brief          : Run-to-completion tasks on the shared main stack
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "sst.h"
+
+#if (!defined CORE_PRIORITY_BITS)
+#    define CORE_PRIORITY_BITS        8
+#endif
+
+namespace
+{
+    volatile uint32_t* const NVIC_ISER = (volatile uint32_t *) 0xE000E100;   // set-enable
+    volatile uint32_t* const NVIC_ISPR = (volatile uint32_t *) 0xE000E200;   // set-pending
+    volatile uint32_t* const NVIC_IPR  = (volatile uint32_t *) 0xE000E400;   // priority
+}
+
+namespace OS
+{
+
+void TSstTask::start(uint8_t priority)
+{
+    const uint32_t prio  = (priority << (8 - CORE_PRIORITY_BITS)) & 0xFF;
+    const uint32_t shift = (IRQn & 3) * 8;
+
+    TCritSect cs;
+    // Cortex-M0 supports word access to IPR only
+    NVIC_IPR[IRQn >> 2] = (NVIC_IPR[IRQn >> 2] & ~(0xFFUL << shift)) | (prio << shift);
+    NVIC_ISER[IRQn >> 5] = 1UL << (IRQn & 31);
+}
+
+
+
+void TSstTask::activate()
+{
+    NVIC_ISPR[IRQn >> 5] = 1UL << (IRQn & 31);
+}
+
+
+
+void TSstTask::run_isr()
+{
+    // services signalled by the task reschedule processes on the way out
+    TISRW isrw;
+    Run(this);
+}
+
+} // ns OS
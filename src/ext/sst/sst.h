@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file           : sst.h
+  * @author         : ruixuezhao
+  * @brief          : Run-to-completion tasks on the shared main stack
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef SST_H
+#define SST_H
+#include "vortexRT.h"
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   TSstTask
+//
+//   Non-blocking task that runs in handler mode on the main stack (MSP).
+//   Each task is bound to a spare interrupt vector: activation pends the
+//   vector, the NVIC calls the task and nests it over lower priority tasks,
+//   so preemption needs no stack of its own and the stack used is the
+//   deepest chain of tasks, not the sum of all of them.
+//
+//   PendSV keeps serving process context switches at the lowest priority,
+//   so all tasks preempt all processes. Tasks must not block: they talk to
+//   processes with the *_isr() service functions only.
+//
+//   The user places run_isr() in the vector's handler:
+//
+//       extern "C" void TIM7_IRQHandler() { Blinker.run_isr(); }
+//
+class TSstTask
+{
+public:
+    typedef void (*TRun)(TSstTask* self);
+
+    // sets NVIC priority (0 is the highest; must be above PendSV) and enables the vector
+    void start(uint8_t priority);
+
+    void activate();                            // from any context, including tasks
+    void run_isr();                             // call from the vector handler
+
+protected:
+    TSstTask(uint16_t irqn, TRun run) : IRQn(irqn), Run(run) { }
+
+    uint16_t IRQn;
+    TRun     Run;
+};
+
+//------------------------------------------------------------------------------
+//
+//   Task with an event queue of QueueSize items. Derived must provide
+//
+//       void dispatch(const T& e);
+//
+//   which is called for each posted event, one at a time, until the queue
+//   is empty.
+//
+template<typename Derived, typename T, uint16_t QueueSize>
+class sst_task : public TSstTask
+{
+public:
+    sst_task(uint16_t irqn) : TSstTask(irqn, &run), HighWater(0), Dropped(0) { }
+
+    bool post(const T& e);                      // from any context; false if the queue is full
+
+    // statistics
+    INLINE uint16_t get_count()      const { TCritSect cs; return Queue.get_count(); }
+    INLINE uint16_t get_high_water() const { TCritSect cs; return HighWater;         }
+    INLINE uint32_t get_dropped()    const { TCritSect cs; return Dropped;           }
+
+private:
+    static void run(TSstTask* self);
+
+    usr::ring_buffer<T, QueueSize, uint16_t> Queue;
+    uint16_t HighWater;
+    uint32_t Dropped;
+};
+
+} // ns OS
+//------------------------------------------------------------------------------
+template<typename Derived, typename T, uint16_t QueueSize>
+bool OS::sst_task<Derived, T, QueueSize>::post(const T& e)
+{
+    {
+        TCritSect cs;
+
+        if( !Queue.push_back(e) )
+        {
+            ++Dropped;
+            return false;
+        }
+        if( Queue.get_count() > HighWater )
+            HighWater = Queue.get_count();
+    }
+    activate();
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename Derived, typename T, uint16_t QueueSize>
+void OS::sst_task<Derived, T, QueueSize>::run(TSstTask* self)
+{
+    sst_task* t = static_cast<sst_task*>(self);
+    for(;;)
+    {
+        T e;
+        {
+            TCritSect cs;
+            if( !t->Queue.pop_front(e) )
+                return;
+        }
+        static_cast<Derived*>(t)->dispatch(e);     // interrupts enabled, higher priority tasks preempt
+    }
+}
+//------------------------------------------------------------------------------
+
+#endif /* SST_H */
@@ -0,0 +1,142 @@
+/**
+  ******************************************************************************
+  * @file           : tlsf_heap.cpp
+  * @author         : ruixuezhao
+  * @brief          : Deterministic heap with kernel locking
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "tlsf_heap.h"
+#include <new>
+#include <cstdlib>
+
+namespace OS
+{
+
+void* THeap::realloc(void* ptr, size_t size)
+{
+    if(!ptr)
+        return malloc(size);
+    if(!size)
+    {
+        free(ptr);
+        return 0;
+    }
+
+    {
+        TCritSect cs;
+        if(Heap.resize(ptr, size))
+            return ptr;
+    }
+
+    // the old block belongs to the caller until it is freed, copy it unlocked
+    void* p = malloc(size);
+    if(p)
+    {
+        const size_t cur = usr::tlsf_heap::usable_size(ptr);
+        memcpy(p, ptr, cur < size ? cur : size);
+        free(ptr);
+    }
+    return p;
+}
+//------------------------------------------------------------------------------
+void* THeap::calloc(size_t count, size_t size)
+{
+    const size_t bytes = count * size;
+    if(size && bytes / size != count)
+        return 0;                                 // overflow
+
+    void* p = malloc(bytes);
+    if(p)
+        memset(p, 0, bytes);
+    return p;
+}
+
+#if vortexRT_HEAP_REPLACE_MALLOC == 1
+
+namespace
+{
+    // constructed on first use: allocation may happen in static constructors
+    // that run before this file's ones
+    alignas(THeap) uint8_t   HeapObject[sizeof(THeap)];
+    alignas(8)     uint8_t   HeapArea[vortexRT_HEAP_SIZE];
+    volatile bool            HeapReady;
+}
+
+THeap& system_heap()
+{
+    THeap* heap = reinterpret_cast<THeap*>(HeapObject);
+    if(!HeapReady)
+    {
+        TCritSect cs;
+        if(!HeapReady)
+        {
+            new (heap) THeap();
+            heap->init(HeapArea, sizeof(HeapArea));
+            HeapReady = true;
+        }
+    }
+    return *heap;
+}
+
+#endif // vortexRT_HEAP_REPLACE_MALLOC
+
+} // ns OS
+
+#if vortexRT_HEAP_REPLACE_MALLOC == 1
+
+//------------------------------------------------------------------------------
+//
+//      C library allocator
+//
+extern "C"
+{
+    struct _reent;
+
+    void* malloc(size_t size)                           { return OS::system_heap().malloc(size);         }
+    void  free(void* ptr)                               { OS::system_heap().free(ptr);                   }
+    void* calloc(size_t count, size_t size)             { return OS::system_heap().calloc(count, size);  }
+    void* realloc(void* ptr, size_t size)               { return OS::system_heap().realloc(ptr, size);   }
+
+    // newlib calls these from stdio and other library internals
+    void* _malloc_r(_reent*, size_t size)               { return OS::system_heap().malloc(size);         }
+    void  _free_r(_reent*, void* ptr)                   { OS::system_heap().free(ptr);                   }
+    void* _calloc_r(_reent*, size_t count, size_t size) { return OS::system_heap().calloc(count, size);  }
+    void* _realloc_r(_reent*, void* ptr, size_t size)   { return OS::system_heap().realloc(ptr, size);   }
+}
+
+//------------------------------------------------------------------------------
+//
+//      C++ allocator
+//
+namespace
+{
+    void* allocate(size_t size)
+    {
+        void* p = OS::system_heap().malloc(size ? size : 1);
+        if(!p)
+        {
+        #if defined(__cpp_exceptions)
+            throw std::bad_alloc();
+        #else
+            abort();
+        #endif
+        }
+        return p;
+    }
+}
+
+void* operator new  (size_t size)                               { return allocate(size); }
+void* operator new[](size_t size)                               { return allocate(size); }
+void* operator new  (size_t size, const std::nothrow_t&) noexcept { return OS::system_heap().malloc(size ? size : 1); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return OS::system_heap().malloc(size ? size : 1); }
+
+void operator delete  (void* ptr) noexcept                        { OS::system_heap().free(ptr); }
+void operator delete[](void* ptr) noexcept                        { OS::system_heap().free(ptr); }
+void operator delete  (void* ptr, size_t) noexcept                { OS::system_heap().free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept                { OS::system_heap().free(ptr); }
+void operator delete  (void* ptr, const std::nothrow_t&) noexcept { OS::system_heap().free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { OS::system_heap().free(ptr); }
+
+#endif // vortexRT_HEAP_REPLACE_MALLOC
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : tlsf_heap.h
+  * @author         : ruixuezhao
+  * @brief          : Deterministic heap with kernel locking
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef TLSF_HEAP_H
+#define TLSF_HEAP_H
+#include "vortexRT.h"
+
+#ifndef vortexRT_HEAP_REPLACE_MALLOC
+#define vortexRT_HEAP_REPLACE_MALLOC    0
+#endif
+
+#ifndef vortexRT_HEAP_SIZE
+#define vortexRT_HEAP_SIZE              8192
+#endif
+
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   THeap
+//
+//   usr::tlsf_heap guarded by a critical section. Every operation holds it
+//   for bounded O(1) time, so the heap may be used from processes and ISRs
+//   alike. A realloc that can't resize in place copies the data between
+//   two locked steps, with interrupts enabled.
+//
+//   With vortexRT_HEAP_REPLACE_MALLOC == 1 the extension replaces global
+//   operator new/delete, malloc/calloc/realloc/free and the newlib _r hooks;
+//   they use system_heap() that lives in a static vortexRT_HEAP_SIZE area
+//   and is set up on first use, so allocation in static constructors works.
+//
+class THeap
+{
+public:
+    INLINE bool   init(void* mem, size_t size)       { TCritSect cs; return Heap.init(mem, size); }
+
+    INLINE void*  malloc(size_t size)                { TCritSect cs; return Heap.malloc(size);       }
+    INLINE void   free(void* ptr)                    { TCritSect cs; Heap.free(ptr);                 }
+           void*  realloc(void* ptr, size_t size);
+           void*  calloc(size_t count, size_t size);
+
+    // statistics
+    INLINE size_t  get_used()          const { TCritSect cs; return Heap.get_used();          }
+    INLINE size_t  get_free()          const { TCritSect cs; return Heap.get_free();          }
+    INLINE size_t  get_peak_used()     const { TCritSect cs; return Heap.get_peak_used();     }
+    INLINE size_t  get_largest_free()  const { TCritSect cs; return Heap.get_largest_free();  }
+    INLINE uint8_t get_fragmentation() const { TCritSect cs; return Heap.get_fragmentation(); }
+
+protected:
+    usr::tlsf_heap Heap;
+};
+
+#if vortexRT_HEAP_REPLACE_MALLOC == 1
+THeap& system_heap();
+#endif
+
+} // ns OS
+
+#endif /* TLSF_HEAP_H */
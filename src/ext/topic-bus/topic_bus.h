@@ -0,0 +1,229 @@
+/**
+  ******************************************************************************
+  * @file           : topic_bus.h
+  * @author         : ruixuezhao
+  * @brief          : Reference-counted publish/subscribe topics
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef TOPIC_BUS_H
+#define TOPIC_BUS_H
+#include "vortexRT.h"
+namespace OS
+{
+
+//------------------------------------------------------------------------------
+//
+//   topic
+//
+//   Latest-value topic for any number of publishers and subscribers. Each
+//   topic is a statically declared object, e.g.
+//
+//       OS::topic<TImu> Imu;
+//
+//   Samples live in a pool of Slots buffers. A publisher fills a buffer
+//   that no one references, then makes it the latest sample and bumps the
+//   generation counter. A subscriber takes a reference to the latest sample
+//   - a pointer plus its generation - and reads it in place; the buffer
+//   isn't reused until the reference is released. Copying happens only in
+//   publish(const T&), outside the critical section; the kernel is entered
+//   only to pick a buffer and to move reference counts.
+//
+//   Slots must exceed the number of references held at once by 2 (the
+//   latest sample and the one being written), otherwise publish() fails.
+//
+template<typename T, uint_fast8_t Slots = 4>
+class topic : protected TService
+{
+    static_assert(Slots >= 2 && Slots < 0xFF, "topic needs 2..254 slots");
+
+public:
+    //--------------------------------------------------------------------------
+    //
+    //   Reference to a published sample, released on destruction
+    //
+    class ref
+    {
+    public:
+        INLINE ref() : Topic(0), Slot(0), Gen(0) { }
+        INLINE ref(ref&& other) : Topic(other.Topic), Slot(other.Slot), Gen(other.Gen) { other.Topic = 0; }
+        INLINE ref& operator=(ref&& other)
+        {
+            if(this != &other)
+            {
+                release();
+                Topic = other.Topic; Slot = other.Slot; Gen = other.Gen;
+                other.Topic = 0;
+            }
+            return *this;
+        }
+        INLINE ~ref() { release(); }
+
+        ref(const ref&) = delete;
+        ref& operator=(const ref&) = delete;
+
+        INLINE explicit operator bool() const { return Topic != 0; }
+        INLINE const T* get()           const { return &Topic->Buf[Slot]; }
+        INLINE const T& operator*()     const { return *get(); }
+        INLINE const T* operator->()    const { return get(); }
+        INLINE uint32_t generation()    const { return Gen; }
+
+        INLINE void release() { if(Topic) { Topic->unref(Slot); Topic = 0; } }
+
+    private:
+        friend class topic;
+        INLINE ref(topic* t, uint_fast8_t slot, uint32_t gen) : Topic(t), Slot(slot), Gen(gen) { }
+
+        topic*       Topic;
+        uint_fast8_t Slot;
+        uint32_t     Gen;
+    };
+
+    INLINE topic() : ProcessMap(0), Latest(NONE), Generation(0), Refs() { }
+
+    // publisher side
+    bool publish    (const T& sample);          // false if all slots are referenced
+    bool publish_isr(const T& sample);
+    T*   claim      ();                         // in-place fill; returns 0 if all slots are referenced
+    void publish    (T* sample);                // commits claimed slot
+    void publish_isr(T* sample);
+
+    // subscriber side
+    ref      read();                            // latest sample, empty ref if nothing published yet
+    ref      wait(uint32_t since, timeout_t timeout = 0);   // waits for generation != since; empty ref on timeout
+
+    INLINE uint32_t generation()                const { TCritSect cs; return Generation; }
+    INLINE bool     updated_since(uint32_t gen) const { TCritSect cs; return Generation != gen; }
+
+protected:
+    enum { NONE = 0xFF, WRITING = 0xFF };
+
+    int_fast8_t take_free_slot();
+    void        commit(uint_fast8_t slot);
+    void        unref(uint_fast8_t slot) { TCritSect cs; --Refs[slot]; }
+
+    volatile TProcessMap ProcessMap;
+    uint_fast8_t Latest;
+    uint32_t     Generation;
+    uint8_t      Refs[Slots];                   // references, WRITING while a publisher fills the slot
+    T            Buf[Slots];
+};
+
+//------------------------------------------------------------------------------
+//
+//       topic function-members implementation
+//
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+int_fast8_t topic<T, Slots>::take_free_slot()
+{
+    TCritSect cs;
+
+    for(uint_fast8_t i = 0; i < Slots; ++i)
+    {
+        if(i != Latest && !Refs[i])
+        {
+            Refs[i] = WRITING;
+            return i;
+        }
+    }
+    return -1;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+void topic<T, Slots>::commit(uint_fast8_t slot)
+{
+    Refs[slot] = 0;
+    Latest     = slot;
+    ++Generation;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+T* topic<T, Slots>::claim()
+{
+    const int_fast8_t slot = take_free_slot();
+    return slot < 0 ? 0 : &Buf[slot];
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+void topic<T, Slots>::publish(T* sample)
+{
+    TCritSect cs;
+
+    commit(sample - Buf);
+    resume_all(ProcessMap);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+void topic<T, Slots>::publish_isr(T* sample)
+{
+    TCritSect cs;
+
+    commit(sample - Buf);
+    resume_all_isr(ProcessMap);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+bool topic<T, Slots>::publish(const T& sample)
+{
+    T* slot = claim();
+    if(!slot)
+        return false;
+
+    *slot = sample;                             // nobody else can see the slot
+    publish(slot);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+bool topic<T, Slots>::publish_isr(const T& sample)
+{
+    T* slot = claim();
+    if(!slot)
+        return false;
+
+    *slot = sample;
+    publish_isr(slot);
+    return true;
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+typename topic<T, Slots>::ref topic<T, Slots>::read()
+{
+    TCritSect cs;
+
+    if(Latest == NONE)
+        return ref();
+
+    ++Refs[Latest];
+    return ref(this, Latest, Generation);
+}
+//------------------------------------------------------------------------------
+template<typename T, uint_fast8_t Slots>
+typename topic<T, Slots>::ref topic<T, Slots>::wait(uint32_t since, timeout_t timeout)
+{
+    TCritSect cs;
+
+    if(Generation == since)
+    {
+        cur_proc_timeout() = timeout;
+        do
+        {
+            // no new sample, suspend current process until published or timeout
+            suspend(ProcessMap);
+            if(is_timeouted(ProcessMap))
+                return ref();
+        }
+        while(Generation == since);
+        cur_proc_timeout() = 0;
+    }
+
+    ++Refs[Latest];
+    return ref(this, Latest, Generation);
+}
+//------------------------------------------------------------------------------
+
+} // ns OS
+
+#endif /* TOPIC_BUS_H */
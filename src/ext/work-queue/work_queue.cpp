@@ -0,0 +1,163 @@
+/**
+  ******************************************************************************
+  * @file           : work_queue.cpp
+  * @author         : ruixuezhao
+  * @brief          : Deferred interrupt work (bottom halves)
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#include "vortexRT.h"          // extensions depending on this one need it declared first
+#include "work_queue.h"
+
+namespace OS
+{
+
+bool TWorkQueue::push(TWork& w, timeout_t delay)
+{
+#if vortexRT_WORKQ_LOCK_FREE == 1
+    if( w.Pending.exchange(true, std::memory_order_acquire) )
+        return false;
+
+    w.Delay = delay;
+    TWork* head = Submitted.load(std::memory_order_relaxed);
+    do
+    {
+        w.Next = head;
+    }
+    while( !Submitted.compare_exchange_weak(head, &w, std::memory_order_release, std::memory_order_relaxed) );
+#else
+    TCritSect cs;
+
+    if( w.Pending.load(std::memory_order_relaxed) )
+        return false;
+    w.Pending.store(true, std::memory_order_relaxed);
+
+    w.Delay = delay;
+    w.Next  = Submitted.load(std::memory_order_relaxed);
+    Submitted.store(&w, std::memory_order_relaxed);
+#endif
+    return true;
+}
+
+
+
+TWork* TWorkQueue::take_submitted()
+{
+#if vortexRT_WORKQ_LOCK_FREE == 1
+    return Submitted.exchange(0, std::memory_order_acquire);
+#else
+    TCritSect cs;
+
+    TWork* list = Submitted.load(std::memory_order_relaxed);
+    Submitted.store(0, std::memory_order_relaxed);
+    return list;
+#endif
+}
+
+
+
+bool TWorkQueue::submit(TWork& w, timeout_t delay)
+{
+    if( !push(w, delay) )
+        return false;
+    Wake.signal();
+    return true;
+}
+
+
+
+bool TWorkQueue::submit_isr(TWork& w, timeout_t delay)
+{
+    if( !push(w, delay) )
+        return false;
+    Wake.signal_isr();
+    return true;
+}
+
+
+
+void TWorkQueue::schedule(TWork* list)
+{
+    // the stack is newest first, reverse it to keep submission order
+    TWork* fifo = 0;
+    while( list )
+    {
+        TWork* w = list;
+        list     = w->Next;
+        w->Next  = fifo;
+        fifo     = w;
+    }
+
+    const tick_count_t now = get_tick_count();
+    while( fifo )
+    {
+        TWork* w = fifo;
+        fifo     = w->Next;
+        w->Due   = now + w->Delay;
+
+        // insert after items with the same due tick
+        TWork** p = &Delayed;
+        while( *p && static_cast<int32_t>((*p)->Due - w->Due) <= 0 )
+            p = &(*p)->Next;
+        w->Next = *p;
+        *p      = w;
+    }
+}
+
+
+
+bool TWorkQueue::run_ready()
+{
+    bool ran = false;
+    for(;;)
+    {
+        if( TWork* list = take_submitted() )
+            schedule(list);
+
+        TWork* w = Delayed;
+        if( !w || static_cast<int32_t>(get_tick_count() - w->Due) < 0 )
+            return ran;
+
+        Delayed = w->Next;
+        w->Pending.store(false, std::memory_order_release);   // may be resubmitted from now on
+        w->Func(w->Context);
+        ran = true;
+    }
+}
+
+
+
+bool TWorkQueue::run_once(timeout_t timeout)
+{
+    for(;;)
+    {
+        if( run_ready() )
+            return true;
+
+        timeout_t wait = timeout;
+        if( Delayed )
+        {
+            // sleep no longer than until the first delayed item is due
+            const int32_t left = static_cast<int32_t>(Delayed->Due - get_tick_count());
+            if( left <= 0 )
+                continue;                         // became due meanwhile
+            const timeout_t max = static_cast<timeout_t>(~0u);
+            const timeout_t due = left < max ? static_cast<timeout_t>(left) : max;
+            if( !wait || due < wait )
+                wait = due;
+        }
+        Wake.wait(wait);
+        return run_ready();
+    }
+}
+
+
+
+void TWorkQueue::run()
+{
+    for(;;)
+        run_once();
+}
+
+} // ns OS
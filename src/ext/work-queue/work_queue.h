@@ -0,0 +1,100 @@
+/**
+  ******************************************************************************
+  * @file           : work_queue.h
+  * @author         : ruixuezhao
+  * @brief          : Deferred interrupt work (bottom halves)
+  * @attention      : None
+  * @date           : 25-5-19
+  ******************************************************************************
+  */
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+#include "vortexRT.h"
+#include <atomic>
+
+//------------------------------------------------------------------------------
+//
+//   Submit method
+//
+//   1 - lock-free: work items are pushed by compare-and-swap, submit() from
+//       an ISR never masks interrupts.
+//   0 - items are pushed inside a critical section. ARMv6-M has no
+//       exclusive access instructions, so it always uses this method.
+//
+#ifndef vortexRT_WORKQ_LOCK_FREE
+#if (defined __ARM_ARCH_6M__)
+#define vortexRT_WORKQ_LOCK_FREE  0
+#else
+#define vortexRT_WORKQ_LOCK_FREE  1
+#endif
+#endif
+
+namespace OS
+{
+
+class TWorkQueue;
+
+//------------------------------------------------------------------------------
+//
+//   TWork
+//
+//   Callback plus context. An item is queued at most once: submitting an
+//   item that is still pending is coalesced with the earlier submission.
+//   The item becomes free again right before its callback runs, so it may
+//   be resubmitted from the callback itself.
+//
+class TWork
+{
+public:
+    typedef void (*TFunc)(void* context);
+
+    TWork(TFunc f, void* context = 0) : Func(f), Context(context), Next(0), Due(0), Delay(0), Pending(false) { }
+
+    INLINE bool is_pending() const { return Pending.load(std::memory_order_relaxed); }
+
+protected:
+    friend class TWorkQueue;
+
+    TFunc                Func;
+    void*                Context;
+    TWork*               Next;
+    tick_count_t         Due;
+    timeout_t            Delay;
+    std::atomic<bool>    Pending;
+};
+
+//------------------------------------------------------------------------------
+//
+//   TWorkQueue
+//
+//   ISRs submit work items, the user's high-priority process runs them by
+//   calling run() from its exec(). Submitted items form a lock-free stack
+//   the worker takes as a whole and runs in submission order; delayed items
+//   wait in a list sorted by due tick that only the worker touches.
+//
+class TWorkQueue
+{
+public:
+    TWorkQueue() : Submitted(0), Delayed(0) { }
+
+    // false if the item is already pending - the submission is coalesced
+    bool submit    (TWork& w, timeout_t delay = 0);
+    bool submit_isr(TWork& w, timeout_t delay = 0);
+
+    NORETURN void run();
+    bool run_once(timeout_t timeout = 0);       // false if nothing was run before timeout
+
+protected:
+    bool   push(TWork& w, timeout_t delay);
+    TWork* take_submitted();                    // detaches the whole submitted stack
+    void   schedule(TWork* list);               // moves submitted items to the due-sorted list
+    bool   run_ready();
+
+    std::atomic<TWork*> Submitted;              // stack of submitted items, newest first
+    TWork*              Delayed;                // sorted by due tick
+    TEventFlag          Wake;
+};
+
+} // ns OS
+
+#endif /* WORK_QUEUE_H */
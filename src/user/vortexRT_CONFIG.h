@@ -102,6 +102,18 @@ typedef uint_fast32_t tick_count_t;
 //
 #define vortexRT_SUSPENDED_PROCESS_ENABLE  0
 
+//-----------------------------------------------------------------------------
+//
+//    System heap (tlsf-heap extension)
+//
+//    1 - global operator new/delete, malloc family and newlib reentrant
+//        allocator hooks are served by OS::THeap over a static area of
+//        vortexRT_HEAP_SIZE bytes.
+//    0 - toolchain allocator is used.
+//
+#define vortexRT_HEAP_REPLACE_MALLOC       0
+#define vortexRT_HEAP_SIZE                 8192
+
 #endif // vortexRT_CONFIG_H
 //-----------------------------------------------------------------------------
 
@@ -6,5 +6,20 @@
 #include <vortex/ext/recursive-mutex/recursive_mutex.h>
 #include <vortex/ext/round-robin/round-robin.h>
 #include <vortex/ext/log/log.hpp>
+#include <vortex/ext/ipc-port/ipc_port.h>
+#include <vortex/ext/rw-lock/rw_lock.h>
+#include <vortex/ext/record-channel/record_channel.h>
+#include <vortex/ext/broadcast-channel/broadcast_channel.h>
+#include <vortex/ext/prio-channel/prio_channel.h>
+#include <vortex/ext/mem-pool/mem_pool.h>
+#include <vortex/ext/mailbox/mailbox.h>
+#include <vortex/ext/tlsf-heap/tlsf_heap.h>
+#include <vortex/ext/topic-bus/topic_bus.h>
+#include <vortex/ext/rcu/rcu.h>
+#include <vortex/ext/coro/coro.h>
+#include <vortex/ext/active-object/active_object.h>
+#include <vortex/ext/sst/sst.h>
+#include <vortex/ext/work-queue/work_queue.h>
+#include <vortex/ext/future/future.h>
 #endif // vortexRT_EXTENSIONS_H
 